@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <errno.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dumpet.h"
+#include "libapplepart.h"
+#include "bless.h"
+#include "hfsplus.h"
+#include "source.h"
+
+static const struct {
+	int word;
+	const char *what;
+} blessed[] = {
+	{ HFS_FINDER_BLESSED_FOLDER, "Blessed system folder" },
+	{ HFS_FINDER_BOOT_FILE, "Boot file" },
+	{ HFS_FINDER_OS9_FOLDER, "Mac OS 9 system folder" },
+	{ HFS_FINDER_OSX_FOLDER, "Mac OS X system folder" },
+};
+
+static void dump_volume(struct hfsplus *hfs)
+{
+	char path[1024];
+	char name[1024];
+	uint32_t parent;
+	int i, rc, any = 0;
+
+	if (hfsplus_thread(hfs, HFS_ROOT_FOLDER_ID, &parent, name,
+			   sizeof(name)) < 0)
+		name[0] = '\0';
+	printf("\tHFS+ volume \"%s\"%s: %u-byte blocks, %u files, "
+	       "%u folders\n", name,
+	       hfs->signature == HFSX_SIGNATURE ? " (HFSX)" : "",
+	       hfs->block_size, hfs->file_count, hfs->folder_count);
+
+	for (i = 0; i < sizeof(blessed) / sizeof(blessed[0]); i++) {
+		uint32_t cnid = hfs->finder_info[blessed[i].word];
+
+		if (!cnid)
+			continue;
+		any = 1;
+		rc = hfsplus_path(hfs, cnid, path, sizeof(path));
+		if (rc == -ENOENT)
+			printf("\t%s: %u (not in the catalog)\n",
+			       blessed[i].what, cnid);
+		else if (rc < 0)
+			printf("\t%s: %u (catalog unreadable: %s)\n",
+			       blessed[i].what, cnid, strerror(-rc));
+		else
+			printf("\t%s: %u %s\n", blessed[i].what, cnid, path);
+	}
+	if (!any)
+		printf("\tNothing is blessed\n");
+}
+
+int dump_blessed(struct context *context)
+{
+	AppleDiskLabel *adl;
+	int fd = fileno(context->iso);
+	int i, found = 0;
+	uint16_t bs;
+
+	stats_phase_begin(PhaseHfs);
+	lseek(fd, 0, SEEK_SET);
+	adl = adl_read(fd);
+	if (!adl) {
+		stats_phase_end(PhaseHfs);
+		fprintf(stderr, "dumpet: no Apple partition map in \"%s\"\n",
+			context->filename);
+		return 5;
+	}
+	bs = adl_get_block_size(adl);
+	printf("Apple Partition Map: %u-byte blocks\n", bs);
+
+	/* adl_get_num_partitions() doesn't count the map's own entry, but
+	 * the accessors do; they fail once we're past the last one. */
+	for (i = 0; ; i++) {
+		char namebuf[33] = "", typebuf[33] = "";
+		char *name = namebuf, *type = typebuf;
+		struct iso_source is;
+		struct hfsplus hfs;
+		uint32_t start, blocks;
+		int rc;
+
+		if (adl_get_partition_type(adl, i, &type) < 0)
+			break;
+		adl_get_partition_name(adl, i, &name);
+		adl_get_partition_pblock_start(adl, i, &start);
+		adl_get_partition_blocks(adl, i, &blocks);
+		/* Apple_HFS and Apple_HFSX */
+		if (strncmp(typebuf, "Apple_HFS", 9))
+			continue;
+
+		printf("Partition %d: \"%s\" (%s), blocks %u-%u\n", i + 1,
+		       namebuf, typebuf, start, start + blocks - 1);
+		if (iso_source_init(&is, context->iso, (uint64_t)start * bs,
+				    (uint64_t)blocks * bs) < 0) {
+			fprintf(stderr, "dumpet: %m\n");
+			break;
+		}
+		rc = hfsplus_open(&hfs, &is.src);
+		if (rc == -EOPNOTSUPP) {
+			printf("\tThe catalog file is in more than 8 extents; "
+			       "not supported\n");
+		} else if (rc < 0) {
+			printf("\tNo HFS+ volume here (%s)\n", strerror(-rc));
+		} else {
+			dump_volume(&hfs);
+			found++;
+		}
+		hfsplus_close(&hfs);
+		iso_source_fini(&is);
+	}
+	adl_free(adl);
+	stats_phase_end(PhaseHfs);
+
+	if (!found) {
+		fprintf(stderr, "dumpet: no HFS+ volume in the Apple partition "
+			"map of \"%s\"\n", context->filename);
+		return 5;
+	}
+	return 0;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
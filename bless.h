@@ -0,0 +1,27 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BLESS_H
+#define BLESS_H
+
+#include "dumpet.h"
+
+/* Find the HFS+ volumes in the image's Apple partition map and report
+ * the folder and file each one has blessed, by ID and by path. */
+extern int dump_blessed(struct context *context);
+
+#endif /* BLESS_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
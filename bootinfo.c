@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "bootinfo.h"
+#include "iso9660.h"
+#include "simd.h"
+
+static const char *problem_names[BOOT_INFO_NPROBLEMS] = {
+	"PVD LBA",
+	"file LBA",
+	"file length",
+	"checksum",
+	"truncated",
+};
+
+const char *boot_info_problem(int i)
+{
+	if (i < 0 || i >= BOOT_INFO_NPROBLEMS)
+		return "unknown";
+	return problem_names[i];
+}
+
+/* Nothing marks the table as being there, so it has to look like one:
+ * the reserved bytes zeroed, a length that gets past the table, and at
+ * least one of the two LBAs still right.  Stale tables keep the PVD's,
+ * which never moves. */
+int boot_info_begin(struct boot_info *bi, const void *data, size_t len,
+		    uint32_t pvd_lba, uint32_t load_lba, uint32_t file_size)
+{
+	const BootInfoTable *table;
+
+	memset(bi, '\0', sizeof(*bi));
+	if (len < BOOT_INFO_SUM_OFFSET)
+		return 0;
+	table = (const BootInfoTable *)
+			((const uint8_t *)data + BOOT_INFO_TABLE_OFFSET);
+
+	bi->PvdLBA = iso731_to_cpu32(table->PvdLBA);
+	bi->FileLBA = iso731_to_cpu32(table->FileLBA);
+	bi->FileLength = iso731_to_cpu32(table->FileLength);
+	bi->Checksum = iso731_to_cpu32(table->Checksum);
+
+	if (!is_zero(table->Reserved, sizeof(table->Reserved)) ||
+			bi->FileLength < BOOT_INFO_SUM_OFFSET ||
+			(bi->PvdLBA != pvd_lba && bi->FileLBA != load_lba)) {
+		memset(bi, '\0', sizeof(*bi));
+		return 0;
+	}
+
+	bi->present = 1;
+	if (bi->PvdLBA != pvd_lba)
+		bi->problems |= BOOT_INFO_BAD_PVD;
+	if (bi->FileLBA != load_lba)
+		bi->problems |= BOOT_INFO_BAD_LBA;
+	if (file_size && bi->FileLength != file_size)
+		bi->problems |= BOOT_INFO_BAD_LENGTH;
+
+	boot_info_feed(bi, data, len);
+	return 1;
+}
+
+void boot_info_feed(struct boot_info *bi, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+	uint64_t base = bi->offset, start, end;
+
+	bi->offset += len;
+	start = base > BOOT_INFO_SUM_OFFSET ? base : BOOT_INFO_SUM_OFFSET;
+	end = bi->offset < bi->FileLength ? bi->offset : bi->FileLength;
+	if (start < end)
+		bi->computed += sum_le32(p + (start - base), end - start);
+}
+
+void boot_info_end(struct boot_info *bi)
+{
+	if (!bi->present)
+		return;
+	if (bi->offset < bi->FileLength)
+		bi->problems |= BOOT_INFO_TRUNCATED;
+	else if (bi->computed != bi->Checksum)
+		bi->problems |= BOOT_INFO_BAD_CHECKSUM;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
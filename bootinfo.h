@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BOOTINFO_H
+#define BOOTINFO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* mkisofs and xorriso's -boot-info-table patch these 56 bytes into a
+ * no-emulation boot file at offset 8, so that isolinux and the like can
+ * find the rest of the medium.  The checksum is the sum of the little
+ * endian 32-bit words of the file from offset 64 to its end. */
+typedef struct {
+	uint32_t PvdLBA;
+	uint32_t FileLBA;
+	uint32_t FileLength;
+	uint32_t Checksum;
+	uint8_t Reserved[40];
+} __attribute__((packed)) BootInfoTable;
+
+#define BOOT_INFO_TABLE_OFFSET 8
+#define BOOT_INFO_SUM_OFFSET 64
+
+/* what doesn't match any more */
+#define BOOT_INFO_BAD_PVD	0x01	/* not where the PVD is */
+#define BOOT_INFO_BAD_LBA	0x02	/* not the catalog's LoadLBA */
+#define BOOT_INFO_BAD_LENGTH	0x04	/* not the directory record's size */
+#define BOOT_INFO_BAD_CHECKSUM	0x08
+#define BOOT_INFO_TRUNCATED	0x10	/* the image ends first */
+#define BOOT_INFO_NPROBLEMS	5
+
+struct boot_info {
+	int present;
+	uint32_t PvdLBA;	/* as recorded in the table */
+	uint32_t FileLBA;
+	uint32_t FileLength;
+	uint32_t Checksum;
+	uint32_t computed;	/* over the file as it is now */
+	uint64_t offset;	/* how much of the file has been fed */
+	int problems;
+};
+
+/* The file is fed through in order from its first byte, in pieces that
+ * are multiples of four bytes long; the first piece must hold at least
+ * BOOT_INFO_SUM_OFFSET bytes.  file_size is 0 if it isn't known.
+ * boot_info_begin() returns whether there is a table at all; nothing
+ * else needs doing if there isn't. */
+extern int boot_info_begin(struct boot_info *bi, const void *data, size_t len,
+			   uint32_t pvd_lba, uint32_t load_lba,
+			   uint32_t file_size);
+extern void boot_info_feed(struct boot_info *bi, const void *data, size_t len);
+extern void boot_info_end(struct boot_info *bi);
+
+/* The name of problem bit i, for output. */
+extern const char *boot_info_problem(int i);
+
+#endif /* BOOTINFO_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
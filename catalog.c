@@ -0,0 +1,359 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dumpet.h"
+#include "catalog.h"
+#include "endian.h"
+
+/* The 16-bit little endian sum of all words of the validation entry,
+ * including the checksum itself; it must come out to zero. */
+static uint16_t validationEntrySum(BootCatalogValidationEntry *ValidationEntry)
+{
+	uint8_t *ve = (uint8_t *)ValidationEntry;
+	uint16_t sum = 0;
+	int i;
+
+	for (i = 0; i < 32; i+=2)
+		sum += ve[i] | (ve[i+1] << 8);
+	return sum;
+}
+
+int checkValidationEntry(BootCatalogValidationEntry *ValidationEntry)
+{
+	if (validationEntrySum(ValidationEntry) != 0)
+		return -1;
+
+	return 0;
+}
+
+/* Recompute the checksum; returns 1 if it had to change. */
+int fixValidationEntry(BootCatalogValidationEntry *ValidationEntry)
+{
+	uint16_t old, checksum;
+
+	memcpy(&old, &ValidationEntry->Checksum, sizeof(old));
+	ValidationEntry->Checksum = 0;
+	checksum = -validationEntrySum(ValidationEntry);
+	checksum = cpu16_to_iso721(checksum);
+	memcpy(&ValidationEntry->Checksum, &checksum, sizeof(checksum));
+	return old != checksum;
+}
+
+void snprintPlatformId(char *buf, size_t n, uint16_t platformId)
+{
+	switch (platformId) {
+		case x86:
+			snprintf(buf, n, "80x86");
+			break;
+		case ppc:
+			snprintf(buf, n, "PPC");
+			break;
+		case m68kmac:
+			snprintf(buf, n, "m68k Macintosh");
+			break;
+		case efi:
+			snprintf(buf, n, "EFI");
+			break;
+		default:
+			snprintf(buf, n, "Unknown");
+			break;
+	}
+}
+
+void snprintBootMediaType(char *buf, size_t n, BootMediaType type)
+{
+	switch (type) {
+		case NoEmulation:
+			snprintf(buf, n, "no emulation");
+			break;
+		case OneTwoDiskette:
+			snprintf(buf, n, "1.2MB floppy diskette emulation");
+			break;
+		case OneFourFourDiskette:
+			snprintf(buf, n, "1.44MB floppy diskette emulation");
+			break;
+		case TwoEightEightDiskette:
+			snprintf(buf, n, "2.88MB floppy diskette emulation");
+			break;
+		case HardDisk:
+			snprintf(buf, n, "hard disk emulation");
+			break;
+		default:
+			snprintf(buf, n, "invalid boot media emulation type");
+			break;
+	}
+}
+
+/* How many 2048-byte sectors the image takes up, going by the spec:
+ * floppy images are the size of the floppy, and otherwise SectorCount is
+ * in 512-byte virtual sectors, so an entry without one loads nothing. */
+uint32_t boot_entry_sectors(struct boot_entry *entry)
+{
+	uint32_t bytes;
+
+	switch (entry->BootMediaType) {
+		case OneTwoDiskette:
+			bytes = 1200 * 1024;
+			break;
+		case OneFourFourDiskette:
+			bytes = 1440 * 1024;
+			break;
+		case TwoEightEightDiskette:
+			bytes = 2880 * 1024;
+			break;
+		default:
+			bytes = entry->SectorCount * 512;
+			break;
+	}
+	return (bytes + sizeof(Sector) - 1) / sizeof(Sector);
+}
+
+/* Default entries and section entries share the layout of their first
+ * twelve bytes, which is everything we decode. */
+static void parse_entry(struct boot_catalog *cat, int index,
+			uint8_t platform_id)
+{
+	BootCatalogSectionEntry *raw = &cat->raw.Catalog[index].SectionEntry;
+	struct boot_entry *entry = &cat->entries[cat->nentries];
+	uint16_t loadseg;
+	uint16_t sectors;
+	uint32_t lba;
+
+	memset(entry, '\0', sizeof(*entry));
+	entry->index = index;
+	entry->filenum = cat->nentries++;
+	entry->PlatformId = platform_id;
+	entry->BootIndicator = raw->BootIndicator;
+	entry->BootMediaType = raw->BootMediaType;
+	entry->SystemType = raw->SystemType;
+	entry->raw = &cat->raw.Catalog[index];
+
+	memcpy(&loadseg, &raw->LoadSegment, sizeof(loadseg));
+	entry->LoadSegment = iso721_to_cpu16(loadseg);
+
+	memcpy(&sectors, &raw->SectorCount, sizeof(sectors));
+	entry->SectorCount = iso721_to_cpu16(sectors);
+
+	memcpy(&lba, &raw->LoadLBA, sizeof(lba));
+	entry->LoadLBA = iso731_to_cpu32(lba);
+}
+
+static struct boot_header *parse_header(struct boot_catalog *cat, int index)
+{
+	BootCatalogEntry *raw = &cat->raw.Catalog[index];
+	struct boot_header *header = &cat->headers[cat->nheaders++];
+
+	memset(header, '\0', sizeof(*header));
+	header->index = index;
+	header->raw = raw;
+	header->HeaderIndicator = raw->ValidationEntry.HeaderIndicator;
+	header->entries = &cat->entries[cat->nentries];
+
+	if (header->HeaderIndicator == ValidationIndicator) {
+		BootCatalogValidationEntry *ve = &raw->ValidationEntry;
+		uint16_t csum;
+
+		header->PlatformId = ve->PlatformId;
+		memcpy(header->Id, ve->Id, sizeof(ve->Id));
+		memcpy(&csum, &ve->Checksum, sizeof(csum));
+		header->Checksum = iso721_to_cpu16(csum);
+		header->KeyBytes[0] = ve->FiveFive;
+		header->KeyBytes[1] = ve->AA;
+	} else if (boot_header_valid(header)) {
+		BootCatalogSectionHeaderEntry *sh = &raw->SectionHeaderEntry;
+		uint16_t count;
+
+		header->PlatformId = sh->PlatformId;
+		memcpy(header->Id, sh->Id, sizeof(sh->Id));
+		memcpy(&count, &sh->SectionEntryCount, sizeof(count));
+		header->SectionEntryCount = iso721_to_cpu16(count);
+	}
+	return header;
+}
+
+/* Decode cat->raw.  The walk is the same one dumpet has always done: the
+ * validation entry and the default entry, then section headers for as
+ * long as they keep coming, each followed by its SectionEntryCount
+ * entries. */
+void parse_boot_catalog(struct boot_catalog *cat)
+{
+	struct boot_header *header;
+	int next;
+
+	cat->nheaders = 0;
+	cat->nentries = 0;
+	cat->checksum_ok =
+		checkValidationEntry(&cat->raw.Catalog[0].ValidationEntry) == 0;
+	if (!cat->checksum_ok)
+		return;
+
+	header = parse_header(cat, 0);
+	if (header->HeaderIndicator != ValidationIndicator)
+		return;
+	parse_entry(cat, 1, header->PlatformId);
+	header->nentries = 1;
+	next = 2;
+
+	while (next < MAX_CATALOG_ENTRIES) {
+		uint8_t indicator =
+			cat->raw.Catalog[next].SectionHeaderEntry.HeaderIndicator;
+		int i;
+
+		if (indicator != SectionHeaderIndicator &&
+				indicator != FinalSectionHeaderIndicator)
+			break;
+
+		header = parse_header(cat, next);
+		for (i = 0; i < header->SectionEntryCount; i++) {
+			if (next + 1 + i >= MAX_CATALOG_ENTRIES)
+				break;
+			parse_entry(cat, next + 1 + i, header->PlatformId);
+		}
+		header->nentries = i;
+		next += 1 + header->SectionEntryCount;
+	}
+}
+
+int read_boot_catalog(FILE *iso, uint32_t lba, struct boot_catalog *cat)
+{
+	int rc;
+
+	memset(cat, '\0', sizeof(*cat));
+	cat->lba = lba;
+	rc = read_sector(iso, lba, &cat->raw.Raw);
+	if (rc < 0)
+		return rc;
+	parse_boot_catalog(cat);
+	return 0;
+}
+
+int write_boot_catalog(FILE *iso, struct boot_catalog *cat)
+{
+	return write_sector_sync(iso, cat->lba, &cat->raw.Raw);
+}
+
+static struct boot_header *entry_header(struct boot_catalog *cat,
+					struct boot_entry *entry)
+{
+	int h;
+
+	for (h = cat->nheaders - 1; h >= 0; h--) {
+		if (cat->headers[h].index < entry->index)
+			return &cat->headers[h];
+	}
+	return NULL;
+}
+
+static int parse_value(const char *value, uint32_t max, uint32_t *out)
+{
+	unsigned long long val;
+	char *end;
+
+	errno = 0;
+	val = strtoull(value, &end, 0);
+	if (errno || end == value || *end != '\0' || val > max)
+		return -1;
+	*out = val;
+	return 0;
+}
+
+/* Apply one "<entry>.<field>=<value>" edit to cat->raw.  Entries are
+ * numbered the way --dumpdisks numbers them: 0 is the default entry.
+ * The caller is expected to fix the checksum and re-parse afterwards. */
+int edit_boot_catalog(struct boot_catalog *cat, const char *edit)
+{
+	static const char *bootable[] = { "no", "false", "yes", "true" };
+	BootCatalogSectionEntry *raw;
+	struct boot_entry *entry;
+	struct boot_header *header;
+	const char *field, *value;
+	char *end;
+	size_t len;
+	uint32_t val;
+	long num;
+	int i;
+
+	errno = 0;
+	num = strtol(edit, &end, 0);
+	if (errno || end == edit || *end != '.' || num < 0 ||
+			num >= cat->nentries)
+		goto bad;
+	entry = &cat->entries[num];
+	header = entry_header(cat, entry);
+	raw = &entry->raw->SectionEntry;
+
+	field = end + 1;
+	value = strchr(field, '=');
+	if (!value)
+		goto bad;
+	len = value++ - field;
+
+#define is_field(name) (len == strlen(name) && !strncmp(field, name, len))
+	if (is_field("bootable")) {
+		for (i = 0; i < 4; i++) {
+			if (!strcmp(value, bootable[i])) {
+				raw->BootIndicator = i < 2 ? NotBootable : Bootable;
+				return 0;
+			}
+		}
+		if (parse_value(value, UINT8_MAX, &val) < 0)
+			goto bad;
+		raw->BootIndicator = val;
+	} else if (is_field("loadseg")) {
+		uint16_t loadseg;
+
+		if (parse_value(value, UINT16_MAX, &val) < 0)
+			goto bad;
+		loadseg = cpu16_to_iso721(val);
+		memcpy(&raw->LoadSegment, &loadseg, sizeof(loadseg));
+	} else if (is_field("sectors")) {
+		uint16_t sectors;
+
+		if (parse_value(value, UINT16_MAX, &val) < 0)
+			goto bad;
+		sectors = cpu16_to_iso721(val);
+		memcpy(&raw->SectorCount, &sectors, sizeof(sectors));
+	} else if (is_field("lba")) {
+		uint32_t lba;
+
+		if (parse_value(value, UINT32_MAX, &val) < 0)
+			goto bad;
+		lba = cpu32_to_iso731(val);
+		memcpy(&raw->LoadLBA, &lba, sizeof(lba));
+	} else if (is_field("platform")) {
+		/* the platform belongs to the entry's header */
+		if (!header || parse_value(value, UINT8_MAX, &val) < 0)
+			goto bad;
+		header->raw->SectionHeaderEntry.PlatformId = val;
+	} else {
+		goto bad;
+	}
+#undef is_field
+	return 0;
+bad:
+	errno = EINVAL;
+	return -1;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
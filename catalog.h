@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "eltorito.h"
+
+#define MAX_CATALOG_ENTRIES (sizeof(BootCatalog) / sizeof(BootCatalogEntry))
+
+/* The boot catalog, decoded once into host byte order.  Everything that
+ * reports on or acts on the catalog works from this rather than from the
+ * raw sector. */
+
+/* A default entry or a section entry */
+struct boot_entry {
+	int index;			/* slot in the catalog sector */
+	int filenum;			/* sequence number for dumped images */
+	uint8_t PlatformId;		/* from the governing header */
+	uint8_t BootIndicator;
+	uint8_t BootMediaType;
+	uint16_t LoadSegment;
+	uint8_t SystemType;
+	uint16_t SectorCount;
+	uint32_t LoadLBA;
+	uint8_t SelectionCriteriaType;	/* section entries only */
+	BootCatalogEntry *raw;
+	struct classification *classification;	/* with --classify */
+	struct authenticode *authenticode;	/* with --authenticode */
+	struct boot_info *boot_info;		/* with --boot-info-table */
+	struct store_object *stored;		/* with --store */
+};
+
+/* The validation entry or a section header entry, and the entries it
+ * governs. */
+struct boot_header {
+	int index;
+	uint8_t HeaderIndicator;
+	uint8_t PlatformId;
+	char Id[29];
+	uint16_t Checksum;		/* validation entry only */
+	uint8_t KeyBytes[2];		/* validation entry only */
+	uint16_t SectionEntryCount;	/* section headers only */
+	int nentries;
+	struct boot_entry *entries;
+	BootCatalogEntry *raw;
+};
+
+struct boot_catalog {
+	uint32_t lba;
+	int checksum_ok;
+	int nheaders;
+	int nentries;
+	struct boot_header headers[MAX_CATALOG_ENTRIES];
+	struct boot_entry entries[MAX_CATALOG_ENTRIES];
+	BootCatalog raw;
+};
+
+static inline int boot_header_valid(struct boot_header *header)
+{
+	switch (header->HeaderIndicator) {
+		case ValidationIndicator:
+		case SectionHeaderIndicator:
+		case FinalSectionHeaderIndicator:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+extern int checkValidationEntry(BootCatalogValidationEntry *ValidationEntry);
+extern int fixValidationEntry(BootCatalogValidationEntry *ValidationEntry);
+extern uint32_t boot_entry_sectors(struct boot_entry *entry);
+extern void parse_boot_catalog(struct boot_catalog *cat);
+extern int read_boot_catalog(FILE *iso, uint32_t lba, struct boot_catalog *cat);
+extern int write_boot_catalog(FILE *iso, struct boot_catalog *cat);
+extern int edit_boot_catalog(struct boot_catalog *cat, const char *edit);
+
+struct context;
+struct classification;
+struct authenticode;
+struct boot_info;
+struct store_object;
+extern int replace_boot_images(struct context *context,
+			       struct boot_catalog *cat);
+
+extern void snprintPlatformId(char *buf, size_t n, uint16_t platformId);
+extern void snprintBootMediaType(char *buf, size_t n, BootMediaType type);
+
+#endif /* CATALOG_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
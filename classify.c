@@ -0,0 +1,402 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "classify.h"
+#include "pe.h"
+#include "endian.h"
+
+/* Boot loaders, in order of precedence when more than one turns up. */
+typedef enum {
+	LoaderShim,
+	LoaderSystemdBoot,
+	LoaderGrub2,
+	LoaderIsolinux,
+	LoaderSyslinux,
+	LoaderEtfsboot,
+	LoaderBootmgr,
+	LoaderIpxe,
+	NumLoaders
+} Loader;
+
+static const char *loader_names[NumLoaders] = {
+	[LoaderShim] = "shim",
+	[LoaderSystemdBoot] = "systemd-boot",
+	[LoaderGrub2] = "GRUB",
+	[LoaderIsolinux] = "ISOLINUX",
+	[LoaderSyslinux] = "SYSLINUX",
+	[LoaderEtfsboot] = "Windows etfsboot",
+	[LoaderBootmgr] = "Windows Boot Manager",
+	[LoaderIpxe] = "iPXE",
+};
+
+static const struct pattern {
+	const char *bytes;
+	size_t len;
+	Loader loader;
+	int version;		/* a version string follows the match */
+	int weak;		/* not enough on its own to identify loader */
+} patterns[] = {
+#define P(s, l, v) { s, sizeof(s) - 1, l, v, 0 }
+	P("UEFI SHIM", LoaderShim, 0),
+	{ "$Version: ", 10, LoaderShim, 1, 1 },
+	P("#### LoaderInfo: systemd-boot ", LoaderSystemdBoot, 1),
+	P("GNU GRUB  version ", LoaderGrub2, 1),
+	P("GRUB \0Geom\0Hard Disk\0Read\0 Error", LoaderGrub2, 0),
+	P("ISOLINUX ", LoaderIsolinux, 1),
+	P("isolinux.bin missing or corrupt", LoaderIsolinux, 0),
+	P("SYSLINUX ", LoaderSyslinux, 1),
+	P("EXTLINUX ", LoaderSyslinux, 1),
+	P("CDBOOT: Cannot boot from CD", LoaderEtfsboot, 0),
+	P("BOOTMGR", LoaderBootmgr, 0),
+	P("iPXE ", LoaderIpxe, 1),
+#undef P
+};
+#define NUM_PATTERNS (sizeof(patterns) / sizeof(patterns[0]))
+
+/* The Aho-Corasick automaton, with the failure links folded into a full
+ * transition table so that each input byte costs exactly one lookup.  It
+ * is built from the table above the first time it's needed. */
+#define MAX_STATES 512
+
+static uint16_t ac_next[MAX_STATES][256];
+static int16_t ac_out[MAX_STATES];	/* pattern ending here, or -1 */
+static uint16_t ac_dict[MAX_STATES];	/* next state with an output on the
+					   failure chain, or 0 */
+static int ac_built;
+
+static void build_automaton(void)
+{
+	static uint16_t fail[MAX_STATES];
+	static uint16_t queue[MAX_STATES];
+	int nstates = 1;
+	int head = 0, tail = 0;
+	size_t p, i;
+	int c;
+
+	memset(ac_next, '\0', sizeof(ac_next));
+	memset(ac_out, 0xff, sizeof(ac_out));
+
+	/* the trie; 0 doubles as "no edge" since nothing points at the root */
+	for (p = 0; p < NUM_PATTERNS; p++) {
+		uint16_t s = 0;
+
+		for (i = 0; i < patterns[p].len; i++) {
+			uint8_t b = patterns[p].bytes[i];
+
+			if (!ac_next[s][b]) {
+				if (nstates == MAX_STATES)
+					abort();	/* grow MAX_STATES */
+				ac_next[s][b] = nstates++;
+			}
+			s = ac_next[s][b];
+		}
+		ac_out[s] = p;
+	}
+
+	/* breadth first, so every state's failure target is already done */
+	for (c = 0; c < 256; c++) {
+		if (ac_next[0][c]) {
+			fail[ac_next[0][c]] = 0;
+			queue[tail++] = ac_next[0][c];
+		}
+	}
+	while (head < tail) {
+		uint16_t s = queue[head++];
+
+		ac_dict[s] = ac_out[fail[s]] >= 0 ? fail[s] : ac_dict[fail[s]];
+		for (c = 0; c < 256; c++) {
+			uint16_t t = ac_next[s][c];
+
+			if (t) {
+				fail[t] = ac_next[fail[s]][c];
+				queue[tail++] = t;
+			} else {
+				ac_next[s][c] = ac_next[fail[s]][c];
+			}
+		}
+	}
+	ac_built = 1;
+}
+
+static int version_char(uint8_t b)
+{
+	return isalnum(b) || b == '.' || b == '-' || b == '_' || b == '+' ||
+	       b == '~';
+}
+
+static struct classify_content *find_content(struct classification *result,
+					     Loader loader);
+
+static struct classify_content *add_content(struct classification *result,
+					    Loader loader)
+{
+	struct classify_content *content = find_content(result, loader);
+
+	if (content || result->ncontents == MAX_CLASSIFY_CONTENTS)
+		return content;
+	content = &result->contents[result->ncontents++];
+	content->name = loader_names[loader];
+	content->version[0] = '\0';
+	return content;
+}
+
+static struct classify_content *find_content(struct classification *result,
+					     Loader loader)
+{
+	int i;
+
+	for (i = 0; i < result->ncontents; i++)
+		if (result->contents[i].name == loader_names[loader])
+			return &result->contents[i];
+	return NULL;
+}
+
+static void end_capture(struct classifier *c)
+{
+	const struct pattern *pat;
+	struct classify_content *content;
+
+	if (c->capture < 0)
+		return;
+	pat = &patterns[c->capture];
+	if (pat->weak)
+		content = find_content(c->result, pat->loader);
+	else
+		content = add_content(c->result, pat->loader);
+	if (content && !content->version[0] && c->caplen) {
+		memcpy(content->version, c->capbuf, c->caplen);
+		content->version[c->caplen] = '\0';
+	}
+	c->capture = -1;
+}
+
+static void matched(struct classifier *c, int p, uint64_t end)
+{
+	if (c->first[p] != UINT64_MAX)
+		return;
+	c->first[p] = end - patterns[p].len;
+	if (!patterns[p].weak)
+		add_content(c->result, patterns[p].loader);
+	if (patterns[p].version && c->capture < 0) {
+		c->capture = p;
+		c->caplen = 0;
+	}
+}
+
+/* Formats that can only be recognized by what's at a fixed offset near
+ * the start of the image. */
+static void classify_headers(struct classification *result,
+			     const uint8_t *p, size_t len)
+{
+	uint16_t u16;
+	uint32_t u32;
+	int i;
+
+	if (len < 512)
+		return;
+
+	/* PE/COFF: "MZ", then e_lfanew points at "PE\0\0"; len is at least
+	 * 512, so checking e_lfanew this way round can't wrap */
+	memcpy(&u32, p + 0x3c, sizeof(u32));
+	u32 = le32_to_cpu(u32);
+	if (p[0] == 'M' && p[1] == 'Z' && u32 <= len - 24 - 70 &&
+			!memcmp(p + u32, "PE\0\0", 4)) {
+		const char *kind = "PE/COFF binary";
+		uint16_t subsystem;
+
+		memcpy(&u16, p + u32 + 4, sizeof(u16));
+		/* the subsystem is at the same place in PE32 and PE32+ */
+		memcpy(&subsystem, p + u32 + 24 + 68, sizeof(subsystem));
+		switch (le16_to_cpu(subsystem)) {
+			case 10: kind = "EFI application"; break;
+			case 11: kind = "EFI boot service driver"; break;
+			case 12: kind = "EFI runtime driver"; break;
+		}
+		snprintf(result->type, sizeof(result->type), "%s (%s)",
+			 kind, pe_machine_name(le16_to_cpu(u16)));
+		return;
+	}
+
+	/* Linux boot protocol: "HdrS" at 0x202 */
+	if (len >= 0x210 && !memcmp(p + 0x202, "HdrS", 4)) {
+		snprintf(result->type, sizeof(result->type), "Linux kernel");
+		return;
+	}
+
+	if (p[510] != 0x55 || p[511] != 0xaa)
+		return;
+
+	/* FAT: the file system type in the BPB, which moves for FAT32 */
+	if (!memcmp(p + 54, "FAT12   ", 8) || !memcmp(p + 54, "FAT16   ", 8) ||
+			!memcmp(p + 54, "FAT     ", 8)) {
+		snprintf(result->type, sizeof(result->type),
+			 "FAT file system (%.5s)", p + 54);
+		return;
+	}
+	if (!memcmp(p + 82, "FAT32   ", 8)) {
+		snprintf(result->type, sizeof(result->type),
+			 "FAT file system (FAT32)");
+		return;
+	}
+
+	/* MBR: a partition table whose entries look sane */
+	for (i = 0; i < 4; i++) {
+		const uint8_t *e = p + 446 + i * 16;
+
+		if ((e[0] != 0x00 && e[0] != 0x80))
+			return;
+	}
+	for (i = 0; i < 4; i++) {
+		if (p[446 + i * 16 + 4] != 0) {
+			snprintf(result->type, sizeof(result->type),
+				 "MBR partitioned disk image");
+			return;
+		}
+	}
+	snprintf(result->type, sizeof(result->type), "boot sector");
+}
+
+int classify_begin(struct classifier *c, struct classification *result)
+{
+	size_t p;
+
+	if (!ac_built)
+		build_automaton();
+
+	memset(c, '\0', sizeof(*c));
+	memset(result, '\0', sizeof(*result));
+	c->result = result;
+	c->capture = -1;
+	c->first = malloc(NUM_PATTERNS * sizeof(*c->first));
+	if (!c->first)
+		return -1;
+	for (p = 0; p < NUM_PATTERNS; p++)
+		c->first[p] = UINT64_MAX;
+	return 0;
+}
+
+void classify_feed(struct classifier *c, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+	uint16_t s = c->state;
+	size_t i;
+
+	if (c->offset == 0)
+		classify_headers(c->result, p, len);
+
+	for (i = 0; i < len; i++) {
+		uint16_t o;
+
+		if (c->capture >= 0) {
+			if (version_char(p[i]) &&
+					c->caplen < sizeof(c->capbuf) - 1)
+				c->capbuf[c->caplen++] = p[i];
+			else
+				end_capture(c);
+		}
+
+		s = ac_next[s][p[i]];
+		if (ac_out[s] >= 0)
+			matched(c, ac_out[s], c->offset + i + 1);
+		for (o = ac_dict[s]; o; o = ac_dict[o])
+			matched(c, ac_out[o], c->offset + i + 1);
+	}
+	c->state = s;
+	c->offset += len;
+}
+
+static void printable(char *buf, size_t n, const struct pattern *pat)
+{
+	size_t i, j = 0;
+
+	for (i = 0; i < pat->len && j + 5 < n; i++) {
+		uint8_t b = pat->bytes[i];
+
+		if (isprint(b) && b != '"' && b != '\\')
+			buf[j++] = b;
+		else
+			j += snprintf(buf + j, n - j, "\\x%02x", b);
+	}
+	buf[j] = '\0';
+}
+
+static int match_cmp(const void *a, const void *b)
+{
+	const struct classify_match *x = a, *y = b;
+
+	if (x->offset != y->offset)
+		return x->offset < y->offset ? -1 : 1;
+	return 0;
+}
+
+static int content_cmp(const void *a, const void *b)
+{
+	const struct classify_content *x = a, *y = b;
+	int i, xi = NumLoaders, yi = NumLoaders;
+
+	for (i = 0; i < NumLoaders; i++) {
+		if (x->name == loader_names[i])
+			xi = i;
+		if (y->name == loader_names[i])
+			yi = i;
+	}
+	return xi - yi;
+}
+
+void classify_end(struct classifier *c)
+{
+	struct classification *result = c->result;
+	static char names[NUM_PATTERNS][96];
+	size_t p;
+
+	end_capture(c);
+
+	qsort(result->contents, result->ncontents, sizeof(result->contents[0]),
+	      content_cmp);
+
+	for (p = 0; p < NUM_PATTERNS; p++) {
+		struct classify_match *m;
+
+		if (c->first[p] == UINT64_MAX ||
+				result->nmatches == MAX_CLASSIFY_MATCHES)
+			continue;
+		if (!names[p][0])
+			printable(names[p], sizeof(names[p]), &patterns[p]);
+		m = &result->matches[result->nmatches++];
+		m->pattern = names[p];
+		m->offset = c->first[p];
+	}
+
+	qsort(result->matches, result->nmatches, sizeof(result->matches[0]),
+	      match_cmp);
+
+	if (!result->type[0])
+		snprintf(result->type, sizeof(result->type), "%s",
+			 result->ncontents ? "boot loader" : "unknown");
+
+	free(c->first);
+	c->first = NULL;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
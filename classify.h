@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* What a boot image turned out to be.  type is the container or binary
+ * format when one is recognized at the start of the image (a FAT file
+ * system, an MBR disk, a PE binary...), and contents lists the boot
+ * loaders found anywhere inside it, each with its version if the loader
+ * announces one. */
+
+#define MAX_CLASSIFY_CONTENTS 8
+#define MAX_CLASSIFY_MATCHES 16
+
+struct classify_content {
+	const char *name;
+	char version[32];
+};
+
+struct classify_match {
+	const char *pattern;	/* printable form */
+	uint64_t offset;
+};
+
+struct classification {
+	char type[64];
+	int ncontents;
+	struct classify_content contents[MAX_CLASSIFY_CONTENTS];
+	int nmatches;
+	struct classify_match matches[MAX_CLASSIFY_MATCHES];
+};
+
+/* The image is fed through in order, in pieces of any size; the first
+ * piece should be at least a sector so that the headers can be checked. */
+struct classifier {
+	struct classification *result;
+	uint64_t offset;
+	uint16_t state;
+	int capture;		/* pattern whose version is being read, or -1 */
+	int caplen;
+	char capbuf[32];
+	uint64_t *first;	/* first offset of each pattern */
+};
+
+extern int classify_begin(struct classifier *c, struct classification *result);
+extern void classify_feed(struct classifier *c, const void *data, size_t len);
+extern void classify_end(struct classifier *c);
+
+#endif /* CLASSIFY_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
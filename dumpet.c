@@ -27,715 +27,297 @@
 #include <string.h>
 #include <unistd.h>
 #include <inttypes.h>
-#include <ctype.h>
+#include <sys/stat.h>
 
 #include <popt.h>
 
-#include <libxml/encoding.h>
-#include <libxml/xmlwriter.h>
-
 #include "dumpet.h"
 #include "endian.h"
-
-struct context {
-	int dumpStdOut;
-	int dumpDiskImage;
-	int dumpHex;
-	int dumpXml;
-
-	xmlTextWriterPtr writer;
-	char *filename;
-	FILE *iso;
-};
-
-static uint32_t dump_boot_record(struct context *context)
+#include "hexdump.h"
+#include "catalog.h"
+#include "render.h"
+#include "volume.h"
+#include "scan.h"
+#include "lint.h"
+#include "bless.h"
+#include "mediacheck.h"
+#include "probe.h"
+#include "index.h"
+#include "simd.h"
+#include "partition.h"
+
+static uint32_t dump_boot_record(struct context *context,
+				 struct descriptor_set *set)
 {
-	BootRecordVolumeDescriptor br;
-	int rc;
 	char BootSystemId[32] = "EL TORITO SPECIFICATION";
-	uint32_t BootCatalogLBA;
+	struct volume_descriptor *br = NULL;
+	int i;
 
-	rc = read_sector(context->iso, 17, (Sector *)&br);
-	if (rc < 0)
+	if (read_descriptor_set(context->iso, set) < 0)
 		exit(3);
 
-	if (br.BootRecordIndicator != 0) {
-		fprintf(stderr, "\"%s\" does not contain an El Torito bootable image.\n", context->filename);
-		fprintf(stderr, "BootRecordIndicator: %d\n", br.BootRecordIndicator);
-		exit(5);
-	}
-	if (strncmp(br.Iso9660, "CD001", 5)) {
-		fprintf(stderr, "\"%s\" does not contain an El Torito bootable image.\n", context->filename);
-		memcpy(BootSystemId, br.Iso9660, 5);
-		BootSystemId[5] = '\0';
-		fprintf(stderr, "ISO-9660 Identifier: \"%s\"\n", BootSystemId);
+	if (set->boot_record >= 0)
+		return set->BootCatalogLBA;
+
+	fprintf(stderr, "\"%s\" does not contain an El Torito bootable image.\n", context->filename);
+	if (set->ndescriptors == 0) {
+		fprintf(stderr, "ISO-9660 Identifier: \"%s\"\n", set->StopId);
 		exit(6);
 	}
-	if (memcmp(br.BootSystemId, BootSystemId, sizeof(BootSystemId))) {
-		int i;
-		fprintf(stderr, "\"%s\" does not contain an El Torito bootable image.\n", context->filename);
-		fprintf(stderr, "target Boot System Identifier: \"");
-		for (i = 0; i < sizeof(BootSystemId); i++)
-			fprintf(stderr, "%02x", BootSystemId[i]);
-		fprintf(stderr, "\n");
-		memcpy(BootSystemId, br.BootSystemId, sizeof(BootSystemId));
-		fprintf(stderr, "actual Boot System Identifier: \"");
-		for (i = 0; i < sizeof(BootSystemId); i++)
-			fprintf(stderr, "%02x", BootSystemId[i]);
-		fprintf(stderr, "\n");
-
-		exit(7);
+	for (i = 0; i < set->ndescriptors; i++) {
+		if (!strcmp(set->descriptors[i].Id, "CD001") &&
+				set->descriptors[i].Type == BootRecordDescriptor) {
+			br = &set->descriptors[i];
+			break;
+		}
+	}
+	if (!br) {
+		fprintf(stderr, "No Boot Record Volume Descriptor in sectors "
+			"16-%u\n", set->StopLBA - 1);
+		exit(5);
 	}
-	memcpy(&BootCatalogLBA, &br.BootCatalogLBA, sizeof(BootCatalogLBA));
-	return iso731_to_cpu32(BootCatalogLBA);
+
+	fprintf(stderr, "target Boot System Identifier: \"");
+	for (i = 0; i < sizeof(BootSystemId); i++)
+		fprintf(stderr, "%02x", BootSystemId[i]);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "actual Boot System Identifier: \"");
+	for (i = 0; i < sizeof(br->BootSystemId); i++)
+		fprintf(stderr, "%02x", br->BootSystemId[i]);
+	fprintf(stderr, "\n");
+	exit(7);
 }
 
-static int checkValidationEntry(struct context *context,
-				BootCatalogValidationEntry *ValidationEntry)
+/* On a forward-only input the catalog and the directory hierarchy, which
+ * the boot images' sizes come from, usually lie between the descriptors
+ * and the boot images, and have to be taken as they go by.  Reading the
+ * file map now, before anything has gone past, is what gets them. */
+static void prepare_stream(struct context *context, uint32_t bootCatLba)
 {
-	uint16_t sum = 0;
-	char *ve = (char *)ValidationEntry;
-	uint16_t checksum;
-	int i;
-
-	memcpy(&checksum, &ValidationEntry->Checksum, sizeof(checksum));
-	checksum = iso721_to_cpu16(checksum);
-	ValidationEntry->Checksum = 0;
+	stream_want(input_stream, bootCatLba, 1);
+	get_file_map(context);
+}
 
-	for (i = 0; i < 32; i+=2) {
-		sum += ve[i];
-		sum += ve[i+1] * 256;
-	}
+static int parseSectorRange(const char *range, uint32_t *lba, uint32_t *count)
+{
+	unsigned long long val;
+	char *end;
 
-	sum += checksum;
-	checksum = cpu16_to_iso721(checksum);
-	memcpy(&ValidationEntry->Checksum, &checksum, sizeof(checksum));
-	if (sum != 0)
+	errno = 0;
+	val = strtoull(range, &end, 0);
+	if (errno || end == range || val > UINT32_MAX)
+		return -1;
+	*lba = val;
+	*count = 1;
+	if (*end == '\0')
+		return 0;
+	if (*end != ':')
 		return -1;
 
+	range = end + 1;
+	val = strtoull(range, &end, 0);
+	if (errno || end == range || *end != '\0' || val == 0 ||
+			val > UINT32_MAX)
+		return -1;
+	*count = val;
 	return 0;
 }
 
-static void snprintPlatformId(char *buf, size_t n, uint16_t platformId)
+/* Dump an arbitrary range of sectors, e.g. a whole boot image or the
+ * system area.  This reads in large chunks and formats into a large
+ * buffer so that multi-megabyte ranges only cost a handful of syscalls. */
+static int dumpHexRange(struct context *context)
 {
-	switch (platformId) {
-		case x86:
-			snprintf(buf, n, "80x86");
-			break;
-		case ppc:
-			snprintf(buf, n, "PPC");
-			break;
-		case m68kmac:
-			snprintf(buf, n, "m68k Macintosh");
-			break;
-		case efi:
-			snprintf(buf, n, "EFI");
-			break;
-		default:
-			snprintf(buf, n, "Unknown");
-			break;
-	}
-}
+	const uint32_t chunk = 256;
+	struct hexdump *hd;
+	struct stat sb;
+	Sector *data;
+	uint32_t lba, count, avail;
+	int rc = 0;
 
-static void dumpHex(void *voiddata, ssize_t length)
-{
-	uint8_t *data = voiddata;
-	int i, j;
-	for (i = j = 0; i < length ; i++) {
-		if (i % 16 == 0) {
-			j = i;
-			printf("%08x  ", i);
-		}
-		printf("%2.2x ", data[i]);
-		if ((i+1) % 16 == 0) {
-			printf(" |");
-			for (; j <= i; j++) {
-				if (isalnum(data[j]))
-					printf("%c", data[j]);
-				else
-					printf(".");
-			}
-			printf("|\n");
-		}
+	if (parseSectorRange(context->hexdumpRange, &lba, &count) < 0) {
+		fprintf(stderr, "dumpet: invalid sector range \"%s\"\n",
+			context->hexdumpRange);
+		return 2;
 	}
-}
 
-static void dumpValidationEntry(BootCatalogValidationEntry *ValidationEntry, struct context *context)
-{
-	char platformbuf[16];
-	char id_string[25];
-	uint16_t csum;
-	
-	snprintPlatformId(platformbuf, 15, ValidationEntry->PlatformId);
-
-	memcpy(id_string, ValidationEntry->Id, 24);
-	id_string[24] = '\0';
-
-	memcpy(&csum, &ValidationEntry->Checksum, sizeof(csum));
-	csum = iso721_to_cpu16(csum);
-
-	if (context->dumpStdOut) {
-		printf("Validation Entry:\n");
-
-		if (context->dumpHex)
-			dumpHex(ValidationEntry, sizeof(*ValidationEntry));
-
-		printf("\tHeader Indicator: 0x%02x (Validation Entry)\n",
-			ValidationEntry->HeaderIndicator);
-		printf("\tPlatformId: 0x%02x (%s)\n", ValidationEntry->PlatformId, platformbuf);
-		printf("\tID: \"%s\"\n", id_string);
-		printf("\tChecksum: 0x%04x\n", csum);
-		printf("\tKey bytes: 0x%02x%02x\n", ValidationEntry->FiveFive,
-						    ValidationEntry->AA);
-	} else if (context->dumpXml) {
-		xmlTextWriterStartElement(context->writer, BAD_CAST "BootCatalogValidationEntry");
-
-		xmlTextWriterStartElement(context->writer, BAD_CAST "PlatformId");
-		xmlTextWriterWriteFormatAttribute(context->writer,
-					BAD_CAST "RawValue", "0x%02x",
-					ValidationEntry->PlatformId);
-		xmlTextWriterStartAttribute(context->writer, BAD_CAST "Value");
-		xmlTextWriterWriteString(context->writer, BAD_CAST platformbuf);
-		xmlTextWriterEndAttribute(context->writer);
-		xmlTextWriterEndElement(context->writer);
-
-		xmlTextWriterWriteFormatElement(context->writer,
-			BAD_CAST "IdString", "%s", id_string);
-
-		xmlTextWriterWriteFormatElement(context->writer,
-			BAD_CAST "Checksum", "%04x", csum);
-
-		xmlTextWriterWriteFormatElement(context->writer,
-			BAD_CAST "KeyBytes", "%02x%02x",
-			ValidationEntry->FiveFive, ValidationEntry->AA);
+	if (fstat(fileno(context->iso), &sb) < 0) {
+		fprintf(stderr, "dumpet: could not stat \"%s\": %m\n",
+			context->filename);
+		return 3;
+	}
+	avail = 0;
+	if (S_ISREG(sb.st_mode) && sb.st_size / sizeof(Sector) > lba)
+		avail = sb.st_size / sizeof(Sector) - lba;
+	if (S_ISREG(sb.st_mode) && count > avail) {
+		fprintf(stderr, "dumpet: \"%s\" ends %u sectors into the "
+			"requested range\n", context->filename, avail);
+		count = avail;
+		rc = 4;
 	}
-}
-
-static void dumpSectionHeaderEntry(BootCatalogSectionHeaderEntry *SectionHeaderEntry, struct context *context)
-{
-	char platformbuf[16];
-	char id_string[29];
-
-	snprintPlatformId(platformbuf, 15, SectionHeaderEntry->PlatformId);
-
-	memcpy(id_string, SectionHeaderEntry->Id, 28);
-	id_string[28] = '\0';
-
-	if (context->dumpStdOut) {
-		printf("Section Header Entry:\n");
-
-		if (context->dumpHex)
-			dumpHex(SectionHeaderEntry, sizeof(*SectionHeaderEntry));
-
-		printf("\tHeader Indicator: 0x%02x ", SectionHeaderEntry->HeaderIndicator);
-		switch (SectionHeaderEntry->HeaderIndicator) {
-			case SectionHeaderIndicator:
-				printf("(Section Header Entry)\n");
-				break;
-			case FinalSectionHeaderIndicator:
-				printf("(Final Section Header Entry)\n");
-				break;
-		}
 
-		printf("\tPlatformId: 0x%02x (%s)\n", SectionHeaderEntry->PlatformId, platformbuf);
-		printf("\tSection Entries: %d\n", SectionHeaderEntry->SectionEntryCount);
-		printf("\tID: \"%s\"\n", id_string);
-	} else if (context->dumpXml) {
-		xmlTextWriterStartElement(context->writer, BAD_CAST "BootCatalogSectionHeaderEntry");
-
-		xmlTextWriterWriteFormatAttribute(context->writer,
-			BAD_CAST "FinalSectionHeaderEntry", "%s",
-			(SectionHeaderEntry->HeaderIndicator == FinalSectionHeaderIndicator ?
-				  "True":"False"));
-
-		xmlTextWriterStartElement(context->writer, BAD_CAST "PlatformId");
-		xmlTextWriterWriteFormatAttribute(context->writer,
-					BAD_CAST "RawValue", "0x%02x",
-					SectionHeaderEntry->PlatformId);
-		xmlTextWriterStartAttribute(context->writer, BAD_CAST "Value");
-		xmlTextWriterWriteString(context->writer, BAD_CAST platformbuf);
-		xmlTextWriterEndAttribute(context->writer);
-		xmlTextWriterEndElement(context->writer);
-
-		xmlTextWriterWriteFormatElement(context->writer,
-			BAD_CAST "IdString", "%s", id_string);
-
-		xmlTextWriterWriteFormatElement(context->writer,
-			BAD_CAST "SectionEntryCount", "%d",
-			SectionHeaderEntry->SectionEntryCount);
+	data = malloc(chunk * sizeof(Sector));
+	hd = malloc(sizeof(*hd));
+	if (!data || !hd) {
+		fprintf(stderr, "dumpet: %m\n");
+		free(data);
+		free(hd);
+		return 3;
 	}
-}
+	hd->fd = STDOUT_FILENO;
+	hd->offset = get_sector_offset(lba);
+	hd->used = 0;
 
-static int dumpBootImage(struct context *context,
-			uint32_t lba, uint32_t sectors,
-			int filenum)
-{
-	int i;
-	int rc = 0;
+	/* each sector is dumped once; a stream needn't keep any of them */
+	if (input_stream)
+		input_stream->keep_reads = 0;
 
-	if (context->dumpStdOut) {
-		FILE *image = NULL;
-		char *filename = NULL;
-		char *template = context->filename;
-		Sector sector;
+	while (count) {
+		uint32_t n = count < chunk ? count : chunk;
 
-		rc = asprintf(&filename, "%s.%d", template, filenum);
-		if (rc < 0)
-			return rc;
-		printf("Dumping boot image to \"%s\"\n", filename);
-		image = fopen(filename, "w+");
-		if (!image) {
-			int errnum;
-			fprintf(stderr, "Could not open \"%s\": %m\n", filename);
-			errnum = errno;
-			free(filename);
-			return -errnum;
-		}
-		free(filename);
-		for (i = 0; i<sectors; i++) {
-			rc = read_sector(context->iso, lba++, &sector);
-			if (rc < 0) {
-				fclose(image);
-				return rc;
-			}
-			rc = write_sector(image, i, &sector);
-			if (rc < 0) {
-				fclose(image);
-				return rc;
-			}
+		if (read_sectors(context->iso, lba, n, data) < 0) {
+			rc = 4;
+			break;
 		}
-	} else if (context->dumpXml) {
-		Sector data[sectors];
-		xmlTextWriterStartElement(context->writer, BAD_CAST "BootImage");
-		int n = 0;
-
-		for (i = 0; i<sectors; i++) {
-			rc = read_sector(context->iso, lba++, &data[i]);
-			if (rc < 0)
-				break;
-			n++;
+		if (hexdump_add(hd, data, n * sizeof(Sector)) < 0) {
+			fprintf(stderr, "dumpet: Error writing hex dump: %m\n");
+			rc = 3;
+			break;
 		}
-		xmlTextWriterWriteFormatAttribute(context->writer,
-			BAD_CAST "HeaderSize", "0x%x", sectors * 2048);
-		xmlTextWriterWriteFormatAttribute(context->writer,
-			BAD_CAST "ActualSize", "0x%x", n * 2048);
-		xmlTextWriterWriteBinHex(context->writer, (char *)data,
-			0, n * sizeof data[0]);
-		xmlTextWriterEndElement(context->writer); /* end BootImage */
+		lba += n;
+		count -= n;
 	}
-	return 0;
-}
-
-static void snprintBootMediaType(char *buf, size_t n, BootMediaType type)
-{
-	switch (type) {
-		case NoEmulation:
-			snprintf(buf, n, "no emulation");
-			break;
-		case OneTwoDiskette:
-			snprintf(buf, n, "1.2MB floppy diskette emulation");
-			break;
-		case OneFourFourDiskette:
-			snprintf(buf, n, "1.44MB floppy diskette emulation");
-			break;
-		case TwoEightEightDiskette:
-			snprintf(buf, n, "2.88MB floppy diskette emulation");
-			break;
-		case HardDisk:
-			snprintf(buf, n, "hard disk emulation");
-			break;
-		default:
-			snprintf(buf, n, "invalid boot media emulation type");
-			break;
+	if (hexdump_flush(hd) < 0 && rc == 0) {
+		fprintf(stderr, "dumpet: Error writing hex dump: %m\n");
+		rc = 3;
 	}
+
+	free(hd);
+	free(data);
+	return rc;
 }
 
-static int dumpEntry(FILE *iso, BootCatalogEntry *bc, int header_num,
-			int entry_num, int *next_header_num,
-			int file_num, struct context *context)
+/* Apply --set edits and --replace replacements and/or repair the
+ * validation entry checksum, and write the catalog sector back if anything
+ * changed. */
+static int editCatalog(struct context *context, struct boot_catalog *cat)
 {
-	BootCatalogValidationEntry *ValidationEntry =
-		(BootCatalogValidationEntry *)&bc[header_num];
-	BootCatalogSectionHeaderEntry *SectionHeaderEntry =
-		(BootCatalogSectionHeaderEntry *)&bc[header_num];
-	unsigned char platform_id;
-
-	switch (ValidationEntry->HeaderIndicator) {
-		case ValidationIndicator:
-			platform_id = ValidationEntry->PlatformId;
-			dumpValidationEntry(ValidationEntry, context);
-			break;
-		case SectionHeaderIndicator:
-		case FinalSectionHeaderIndicator:
-			platform_id = SectionHeaderEntry->PlatformId;
-			dumpSectionHeaderEntry(SectionHeaderEntry, context);
-			break;
-		default:
-			/* almost always x86 anyway -- if it's broken, it's
-			 * probably still x86. */
-			platform_id = 0;
-			if (context->dumpStdOut) {
-				fprintf(stderr,
-					"Invalid Header Indicator (0x%04x), skipping\n",
-					ValidationEntry->HeaderIndicator);
-			}
-			return -1;
+	BootCatalogValidationEntry *ve = &cat->raw.Catalog[0].ValidationEntry;
+	Sector orig;
+	int i, rc;
+
+	if (ve->HeaderIndicator != ValidationIndicator ||
+			ve->FiveFive != 0x55 || ve->AA != 0xaa) {
+		fprintf(stderr, "dumpet: no validation entry at sector %u of "
+			"\"%s\", not editing\n", cat->lba, context->filename);
+		return 5;
 	}
 
-	if (ValidationEntry->HeaderIndicator == ValidationIndicator) {
-		BootCatalogDefaultEntry *DefaultEntry =
-			(BootCatalogDefaultEntry *)&bc[entry_num];
-
-		uint16_t loadseg;
-		uint16_t sectors;
-		uint32_t lba;
-		char bmtype[64];
-
-		snprintBootMediaType(bmtype, 63, DefaultEntry->BootMediaType);
-
-		memcpy(&loadseg, &DefaultEntry->LoadSegment, sizeof(loadseg));
-		loadseg = iso721_to_cpu16(loadseg);
-
-		memcpy(&sectors, &DefaultEntry->SectorCount, sizeof(sectors));
-		sectors = iso721_to_cpu16(sectors);
-
-		memcpy(&lba, &DefaultEntry->LoadLBA, sizeof(lba));
-		lba = iso731_to_cpu32(lba);
-
-		if (context->dumpStdOut) {
-			uint16_t loadseg;
-			uint16_t sectors;
-			uint32_t lba;
-			char bmtype[64];
-
-			snprintBootMediaType(bmtype, 63, DefaultEntry->BootMediaType);
-
-			memcpy(&loadseg, &DefaultEntry->LoadSegment, sizeof(loadseg));
-			loadseg = iso721_to_cpu16(loadseg);
-
-			memcpy(&sectors, &DefaultEntry->SectorCount, sizeof(sectors));
-			sectors = iso721_to_cpu16(sectors);
-
-			memcpy(&lba, &DefaultEntry->LoadLBA, sizeof(lba));
-			lba = iso731_to_cpu32(lba);
-
-			printf("Boot Catalog Default Entry:\n");
-
-			if (context->dumpHex)
-				dumpHex(DefaultEntry, sizeof(*DefaultEntry));
-
-			switch (DefaultEntry->BootIndicator) {
-				case NotBootable:
-					printf("\tEntry is not bootable\n");
-					break;
-				case Bootable:
-					printf("\tEntry is bootable\n");
-					break;
-				default:
-					printf("\tInvalid boot indicator\n");
-					break;
-			}
-
-			printf("\tBoot Media emulation type: %s\n", bmtype);
-
-			switch (platform_id) {
-				case x86:
-					printf("\tMedia load segment: ");
-					if (loadseg == 0)
-						printf("0x0 (0000:7c00)\n");
-					else
-						printf("0x%04x (%04x:0000)\n", loadseg,
-							loadseg);
-					break;
-				case ppc:
-				case m68kmac:
-				case efi:
-					printf("\tMedia load address: %d (0x%04x)\n",
-						loadseg * 0x10, loadseg * 0x10);
-					break;
-				default:
-					printf("\tMedia load address: %d (0x%04x) (raw value)\n",
-						loadseg, loadseg);
-					break;
-			}
-
-			printf("\tSystem type: %d (0x%02x)\n", DefaultEntry->SystemType,
-				DefaultEntry->SystemType);
-
-			printf("\tLoad Sectors: %d (0x%04x)\n", sectors, sectors);
-
-			printf("\tLoad LBA: %d (0x%08x)\n", lba, lba);
-
-		} else if (context->dumpXml) {
-			xmlTextWriterStartElement(context->writer,
-				BAD_CAST "BootCatalogDefaultEntry");
-
-			xmlTextWriterWriteFormatElement(context->writer,
-				BAD_CAST "Bootable", "%s",
-				DefaultEntry->BootIndicator ? "True" : "False");
-
-			xmlTextWriterWriteFormatElement(context->writer,
-				BAD_CAST "BootMediaEmulationType", "%s", bmtype);
-
-			xmlTextWriterStartElement(context->writer,
-				BAD_CAST "MediaLoadSegment");
-			switch (platform_id) {
-				case x86:
-					xmlTextWriterWriteFormatAttribute(context->writer,
-						BAD_CAST "RawValue",
-						"0x%04x", loadseg);
-					if (loadseg == 0) {
-						xmlTextWriterWriteFormatAttribute(
-							context->writer,
-							BAD_CAST "Value",
-							"0000:7c00");
-					} else {
-						xmlTextWriterWriteFormatAttribute(
-							context->writer,
-							BAD_CAST "Value",
-							"%04x:0000", loadseg);
-					}
-					xmlTextWriterWriteFormatAttribute(
-						context->writer, BAD_CAST "ValueType",
-						"Interpreted");
-					break;
-				case ppc:
-				case m68kmac:
-				case efi:
-					xmlTextWriterWriteFormatAttribute(context->writer,
-						BAD_CAST "RawValue",
-						"0x%04x", loadseg);
-					xmlTextWriterWriteFormatAttribute(context->writer,
-						BAD_CAST "Value",
-						"0x%04x", loadseg * 0x10);
-					xmlTextWriterWriteFormatAttribute(
-						context->writer, BAD_CAST "ValueType",
-						"Interpreted");
-					break;
-				default:
-					xmlTextWriterWriteFormatAttribute(context->writer,
-						BAD_CAST "RawValue",
-						"0x%04x", loadseg);
-					xmlTextWriterWriteFormatAttribute(context->writer,
-						BAD_CAST "Value",
-						"0x%04x", loadseg);
-					xmlTextWriterWriteFormatAttribute(
-						context->writer, BAD_CAST "ValueType",
-						"Raw");
-					break;
-			}
-			xmlTextWriterEndElement(context->writer); /* end MediaLoadSegment */
-
-			xmlTextWriterWriteFormatElement(context->writer,
-				BAD_CAST "SystemType", "0x%02x",
-				DefaultEntry->SystemType);
-
-			xmlTextWriterWriteFormatElement(context->writer,
-				BAD_CAST "LoadSectors", "0x%04x", sectors);
-
-			xmlTextWriterWriteFormatElement(context->writer,
-				BAD_CAST "LoadLBA", "0x%08x", lba);
-		}
+	memcpy(orig, cat->raw.Raw, sizeof(orig));
 
-		if (context->dumpDiskImage)
-			dumpBootImage(context, lba, sectors, file_num++);
+	/* the entries can't be found until the checksum is right */
+	fixValidationEntry(ve);
+	parse_boot_catalog(cat);
 
-		if (context->dumpXml)
-			xmlTextWriterEndElement(context->writer); /* end BootCatalogDefaultEntry */
-
-		*next_header_num = entry_num + 1;
-	} else {
-		int i;
-
-		for (i = 0; i < SectionHeaderEntry->SectionEntryCount; i++) {
-			BootCatalogSectionEntry *SectionEntry =
-				(BootCatalogSectionEntry *)&bc[entry_num + i];
-
-			uint16_t loadseg;
-			uint16_t sectors;
-			uint32_t lba;
-			char bmtype[64];
-
-			snprintBootMediaType(bmtype, 63, SectionEntry->BootMediaType);
-
-			memcpy(&loadseg, &SectionEntry->LoadSegment, sizeof(loadseg));
-			loadseg = iso721_to_cpu16(loadseg);
-
-			memcpy(&sectors, &SectionEntry->SectorCount, sizeof(sectors));
-			sectors = iso721_to_cpu16(sectors);
-
-			memcpy(&lba, &SectionEntry->LoadLBA, sizeof(lba));
-			lba = iso731_to_cpu32(lba);
-
-			if (context->dumpStdOut) {
-				printf("Boot Catalog Section Entry:\n");
-
-				if (context->dumpHex)
-					dumpHex(SectionEntry, sizeof(*SectionEntry));
-
-				switch (SectionEntry->BootIndicator) {
-					case NotBootable:
-						printf("\tEntry is not bootable\n");
-						break;
-					case Bootable:
-						printf("\tEntry is bootable\n");
-						break;
-					default:
-						printf("\tInvalid boot indicator\n");
-						break;
-				}
-				printf("\tBoot Media emulation type: %s\n", bmtype);
-
-				switch (platform_id) {
-					case x86:
-						printf("\tMedia load segment: 0x%04x\n",
-							loadseg == 0 ? 0x7c0 : loadseg);
-						break;
-					case ppc:
-					case m68kmac:
-					case efi:
-						printf("\tMedia load address: %d (0x%04x)\n",
-							loadseg * 0x10, loadseg * 0x10);
-						break;
-					default:
-						printf("\tMedia load address: %d (0x%04x) (raw value)\n",
-							loadseg, loadseg);
-						break;
-				}
-
-				printf("\tSystem type: %d (0x%02x)\n", SectionEntry->SystemType,
-					SectionEntry->SystemType);
-				printf("\tLoad Sectors: %d (0x%04x)\n", sectors, sectors);
-				printf("\tLoad LBA: %d (0x%08x)\n", lba, lba);
-
-			} else if (context->dumpXml) {
-				xmlTextWriterStartElement(context->writer,
-					BAD_CAST "BootCatalogSectionEntry");
-
-				xmlTextWriterWriteFormatElement(context->writer,
-					BAD_CAST "Bootable", "%s",
-					SectionEntry->BootIndicator ? "True" : "False");
-
-				xmlTextWriterWriteFormatElement(context->writer,
-					BAD_CAST "BootMediaEmulationType", "%s", bmtype);
-
-				xmlTextWriterStartElement(context->writer,
-					BAD_CAST "MediaLoadSegment");
-				switch (platform_id) {
-					case x86:
-						xmlTextWriterWriteFormatAttribute(context->writer,
-							BAD_CAST "RawValue",
-							"0x%04x", loadseg);
-						if (loadseg == 0) {
-							xmlTextWriterWriteFormatAttribute(
-								context->writer,
-								BAD_CAST "Value",
-								"0000:7c00");
-						} else {
-							xmlTextWriterWriteFormatAttribute(
-								context->writer,
-								BAD_CAST "Value",
-								"%04x:0000", loadseg);
-						}
-						xmlTextWriterWriteFormatAttribute(
-							context->writer, BAD_CAST "ValueType",
-							"Interpreted");
-						break;
-					case ppc:
-					case m68kmac:
-					case efi:
-						xmlTextWriterWriteFormatAttribute(context->writer,
-							BAD_CAST "RawValue",
-							"0x%04x", loadseg);
-						xmlTextWriterWriteFormatAttribute(context->writer,
-							BAD_CAST "Value",
-							"0x%04x", loadseg * 0x10);
-						xmlTextWriterWriteFormatAttribute(
-							context->writer, BAD_CAST "ValueType",
-							"Interpreted");
-						break;
-					default:
-						xmlTextWriterWriteFormatAttribute(context->writer,
-							BAD_CAST "RawValue",
-							"0x%04x", loadseg);
-						xmlTextWriterWriteFormatAttribute(context->writer,
-							BAD_CAST "Value",
-							"0x%04x", loadseg);
-						xmlTextWriterWriteFormatAttribute(
-							context->writer, BAD_CAST "ValueType",
-							"Raw");
-						break;
-				}
-				xmlTextWriterEndElement(context->writer); /* end MediaLoadSegment */
-
-				xmlTextWriterWriteFormatElement(context->writer,
-					BAD_CAST "SystemType", "0x%02x",
-					SectionEntry->SystemType);
-
-				xmlTextWriterWriteFormatElement(context->writer,
-					BAD_CAST "LoadSectors", "0x%04x", sectors);
-
-				xmlTextWriterWriteFormatElement(context->writer,
-					BAD_CAST "LoadLBA", "0x%08x", lba);
-			}
-
-			if (context->dumpDiskImage)
-				dumpBootImage(context, lba, sectors, file_num++);
-
-			if (context->dumpXml)
-				xmlTextWriterEndElement(context->writer); /* end BootCatalogSectionEntry */
+	for (i = 0; i < context->nedits; i++) {
+		if (edit_boot_catalog(cat, context->edits[i]) < 0) {
+			fprintf(stderr, "dumpet: invalid edit \"%s\"\n",
+				context->edits[i]);
+			return 2;
 		}
-		*next_header_num = entry_num + i;
 	}
 
-	if (context->dumpXml) {
-		/* Either A ValidationEntry or a SectionHeaderEntry is open here */
-		xmlTextWriterEndElement(context->writer);
+	/* replacements go where the edited entries say, and are all
+	 * checked before anything is written */
+	if (context->nreplacements) {
+		fixValidationEntry(ve);
+		parse_boot_catalog(cat);
+		rc = replace_boot_images(context, cat);
+		if (rc)
+			return rc;
 	}
 
+	fixValidationEntry(ve);
+	parse_boot_catalog(cat);
+
+	if (!memcmp(orig, cat->raw.Raw, sizeof(orig))) {
+		fprintf(stderr, "dumpet: boot catalog unchanged\n");
+		return 0;
+	}
+
+	rc = write_boot_catalog(context->iso, cat);
+	if (rc < 0)
+		return 3;
+	fprintf(stderr, "dumpet: updated boot catalog at sector %u\n",
+		cat->lba);
 	return 0;
 }
 
 static int dumpet(struct context *context)
 {
-	BootCatalog bc;
+	struct descriptor_set *set;
+	struct boot_catalog *cat;
 	uint32_t bootCatLba;
-	int filenum = 0;
-	int next_header_num = 0;
 	int rc;
 
-	bootCatLba = dump_boot_record(context);
+	set = malloc(sizeof(*set));
+	cat = malloc(sizeof(*cat));
+	if (!set || !cat) {
+		fprintf(stderr, "dumpet: %m\n");
+		exit(3);
+	}
+	context->volume = set;
+
+	stats_phase_begin(PhaseBootRecord);
+	bootCatLba = dump_boot_record(context, set);
+	if (input_stream)
+		prepare_stream(context, bootCatLba);
+	stats_phase_end(PhaseBootRecord);
 
-	rc = read_sector(context->iso, bootCatLba, (Sector *)&bc);
+	stats_phase_begin(PhaseCatalog);
+	rc = read_boot_catalog(context->iso, bootCatLba, cat);
+	stats_phase_end(PhaseCatalog);
 	if (rc < 0)
 		exit(4);
 
-	rc = checkValidationEntry(context, &bc.Catalog[0].ValidationEntry);
-	if (rc < 0) {
-		if (context->dumpStdOut)
-			printf("Validation Entry Checksum is incorrect\n");
-		return -1;
-	}
-	rc = dumpEntry(context->iso, &bc.Catalog[0],
-			next_header_num, next_header_num+1, &next_header_num,
-			filenum++, context);
-
-	while (1) {
-		BootCatalogSectionHeaderEntry *SectionHeader =
-			(BootCatalogSectionHeaderEntry *)&bc.Catalog[next_header_num];
-
-		if (SectionHeader->HeaderIndicator == SectionHeaderIndicator ||
-				SectionHeader->HeaderIndicator == FinalSectionHeaderIndicator) {
-			rc = dumpEntry(context->iso, &bc.Catalog[0], next_header_num, next_header_num+1,
-					&next_header_num, filenum++, context);
-		} else {
-			break;
+	if (context->fixChecksum || context->nedits || context->nreplacements) {
+		rc = editCatalog(context, cat);
+		if (rc) {
+			free(cat);
+			free(set);
+			free_file_map(context->files);
+			context->files = NULL;
+			context->volume = NULL;
+			return rc;
 		}
 	}
 
-	//write(STDOUT_FILENO, &bc, sizeof(bc));
+	rc = render_catalog(context, cat);
 
-	return 0;
+	free(cat);
+	free(set);
+	free_file_map(context->files);
+	context->files = NULL;
+	context->volume = NULL;
+	return rc;
+}
+
+/* A forward-only input is read to the end before it's closed, so that
+ * whatever is writing it (a tee making a copy, say) isn't cut short; the
+ * results are already out by then. */
+static void close_image(struct context *context)
+{
+	int rc;
+
+	if (input_stream) {
+		fflush(stdout);
+		rc = stream_close(input_stream);
+		input_stream = NULL;
+		if (rc < 0)
+			fprintf(stderr, "dumpet: Error reading image: %s\n",
+				strerror(-rc));
+	}
+	fclose(context->iso);
 }
 
 static void usage(int error)
@@ -743,31 +325,108 @@ static void usage(int error)
 	FILE *outfile = error ? stderr : stdout;
 
 	fprintf(outfile, "usage: dumpet --help\n"
-	                 "       dumpet -i <file> [-d] [-h|-x]\n");
+	                 "       dumpet -i <file> [-d] [-h|-x [--base64]] [-o <format>[:<file>]]...\n"
+	                 "              [--volume] [--classify] [--authenticode] [--boot-info-table]\n"
+	                 "              [--store <dir>] [--stats]\n"
+	                 "       dumpet -i <file> --hexdump <lba>[:<count>]\n"
+	                 "       dumpet -i <file> --probe\n"
+	                 "       dumpet -i <file> --lint\n"
+	                 "       dumpet -i <file> --blessed\n"
+	                 "       dumpet -i <file> --partitions\n"
+	                 "       dumpet -i <file> --partition [<table>:]<index>|<type>...\n"
+	                 "       dumpet -i <file> --mediacheck\n"
+	                 "       dumpet -i <file> --scan [--threads <n>]\n"
+	                 "       dumpet --index-build <index> <file>...\n"
+	                 "       dumpet --index-query <index> <field>=<value>...\n"
+	                 "       dumpet -i <file> [--fix-checksum] [--set <entry>.<field>=<value>]...\n"
+	                 "              [--replace <entry>=<file>]...\n");
 	exit(error);
 }
 
+static void append_arg(char ***list, int *n, char *arg)
+{
+	char **new = realloc(*list, (*n + 1) * sizeof(**list));
+
+	if (!new) {
+		fprintf(stderr, "dumpet: %m\n");
+		exit(3);
+	}
+	new[(*n)++] = arg;
+	*list = new;
+}
+
 int main(int argc, char *argv[])
 {
 	int rc;
 
 	int help = 0;
 	struct context context = { 0 };
-	xmlBufferPtr xml = NULL;
+	char **outputs = NULL;
+	int noutputs = 0;
+	char *simdVariant = NULL;
+	char *indexBuild = NULL;
+	char *indexQuery = NULL;
+	int editing;
+	int i;
 
 	poptContext optCon;
 	struct poptOption optionTable[] = {
 		{ "help", '?', POPT_ARG_NONE, &help, 0, NULL, "help"},
+		{ "blessed", '\0', POPT_ARG_NONE, &context.blessed, 0, NULL, "show what the HFS+ volumes in the Apple partition map have blessed"},
+		{ "mediacheck", '\0', POPT_ARG_NONE, &context.mediaCheck, 0, NULL, "verify the image against the MD5 and fragment sums implanted by implantisomd5"},
+		{ "classify", '\0', POPT_ARG_NONE, &context.classify, 0, NULL, "identify the boot loader in each boot image"},
+		{ "authenticode", '\0', POPT_ARG_NONE, &context.authenticode, 0, NULL, "compute the Authenticode SHA-256 of each EFI binary"},
+		{ "boot-info-table", '\0', POPT_ARG_NONE, &context.bootInfo, 0, NULL, "check the boot info table of each no-emulation boot image"},
+		{ "base64", '\0', POPT_ARG_NONE, &context.base64, 0, NULL, "encode boot images in XML output as base64 rather than hex"},
 		{ "dumpdisks", 'd', POPT_ARG_NONE, &context.dumpDiskImage, 0, NULL, "dump each El Torito boot image into a file"},
+		{ "fix-checksum", '\0', POPT_ARG_NONE, &context.fixChecksum, 0, NULL, "recompute the validation entry checksum and write it back"},
 		{ "dumphex", 'h', POPT_ARG_NONE, &context.dumpHex, 0, NULL, "dump each El Torito structure in hex"},
+		{ "hexdump", '\0', POPT_ARG_STRING, &context.hexdumpRange, 0, NULL, "dump a range of sectors (<lba>[:<count>]) in hex"},
+		{ "index-build", '\0', POPT_ARG_STRING, &indexBuild, 0, NULL, "write an index of the boot catalogs of the images named after the options to <index>"},
+		{ "index-query", '\0', POPT_ARG_STRING, &indexQuery, 0, NULL, "list the indexed images with an entry matching every <field>=<value> named after the options"},
 		{ "iso", 'i', POPT_ARG_STRING, &context.filename, 0, NULL, "input ISO image"},
+		{ "lint", '\0', POPT_ARG_NONE, &context.lint, 0, NULL, "check the volume descriptors and boot catalog for structural problems"},
+		{ "output", 'o', POPT_ARG_STRING, NULL, 'o', NULL, "write the El Torito structure as <format> (text, xml, tar, cpio, fingerprint or fingerprint-images) to stdout or <file>; may be repeated"},
+		{ "partition", '\0', POPT_ARG_STRING, NULL, 'p', NULL, "copy the APM, MBR or GPT partitions matching <selector> ([apm:|mbr:|gpt:]<index> or <type>) into files; may be repeated"},
+		{ "partitions", '\0', POPT_ARG_NONE, &context.listPartitions, 0, NULL, "list the partitions in the Apple partition map, MBR and GPT"},
+		{ "probe", '\0', POPT_ARG_NONE, &context.probe, 0, NULL, "print a one-line summary of the boot catalog, reading only the boot record and the catalog"},
+		{ "replace", '\0', POPT_ARG_STRING, NULL, 'r', NULL, "overwrite the boot image of entry <entry> in place with <file> (<entry>=<file>); may be repeated"},
+		{ "scan", '\0', POPT_ARG_NONE, &context.scan, 0, NULL, "ignore the volume descriptors and search the whole image for boot catalogs"},
+		{ "set", '\0', POPT_ARG_STRING, NULL, 's', NULL, "set a boot catalog field (bootable, loadseg, sectors, lba or platform) of entry <entry> and fix the checksum; may be repeated"},
+		{ "store", '\0', POPT_ARG_STRING, &context.storeDir, 0, NULL, "write each boot image once into the content-addressed directory <dir>, with a manifest for this image"},
+		{ "threads", '\0', POPT_ARG_INT, &context.threads, 0, NULL, "number of threads to use for --scan (default: one per CPU)"},
+		{ "simd", '\0', POPT_ARG_STRING, &simdVariant, 0, NULL, "use the <variant> (avx2, avx512, sse4.2 or generic) build of the vector kernels rather than the best this CPU has"},
+		{ "stats", '\0', POPT_ARG_NONE, &context.stats, 0, NULL, "report per-phase timing and I/O statistics on stderr"},
+		{ "volume", '\0', POPT_ARG_NONE, &context.dumpVolume, 0, NULL, "also dump the volume descriptor set and primary volume descriptor"},
 		{ "xml", 'x', POPT_ARG_NONE, &context.dumpXml, 0, NULL, "dump the El Torito structure as an XML document"},
 		{0}
 	};
 
 	optCon = poptGetContext(NULL, argc, (const char **)argv, optionTable, 0);
 
-	if ((rc = poptGetNextOpt(optCon)) < -1) {
+	while ((rc = poptGetNextOpt(optCon)) > 0) {
+		switch (rc) {
+			case 'o':
+				append_arg(&outputs, &noutputs,
+					   poptGetOptArg(optCon));
+				break;
+			case 's':
+				append_arg(&context.edits, &context.nedits,
+					   poptGetOptArg(optCon));
+				break;
+			case 'r':
+				append_arg(&context.replacements,
+					   &context.nreplacements,
+					   poptGetOptArg(optCon));
+				break;
+			case 'p':
+				append_arg(&context.partitions,
+					   &context.npartitions,
+					   poptGetOptArg(optCon));
+				break;
+		}
+	}
+	if (rc < -1) {
 		fprintf(stderr, "dumpet: bad option \"%s\": %s\n",
 			poptBadOption(optCon, POPT_BADOPTION_NOALIAS),
 			poptStrerror(rc));
@@ -777,55 +436,166 @@ int main(int argc, char *argv[])
 
 	if (help)
 		usage(0);
-	else if (!context.filename)
+
+	if (simd_select(simdVariant ? simdVariant : getenv("DUMPET_SIMD")) < 0)
+		exit(2);
+	free(simdVariant);
+
+	/* these work on many images, or none, rather than on -i */
+	if (indexBuild || indexQuery) {
+		char **args = NULL;
+		const char *arg;
+		int nargs = 0;
+
+		if (indexBuild && indexQuery)
+			usage(2);
+		while ((arg = poptGetArg(optCon)) != NULL)
+			append_arg(&args, &nargs, (char *)arg);
+		if (indexBuild)
+			rc = build_index(indexBuild, args, nargs);
+		else
+			rc = query_index(indexQuery, args, nargs);
+		free(args);
+		free(indexBuild);
+		free(indexQuery);
+		free(context.filename);
+		poptFreeContext(optCon);
+		return rc;
+	}
+
+	if (!context.filename)
 		usage(3);
 
-	context.iso = fopen(context.filename, "r");
+	if (context.stats)
+		stats_enable();
+
+	editing = context.fixChecksum || context.nedits ||
+		  context.nreplacements;
+	if (!strcmp(context.filename, "-")) {
+		if (editing) {
+			fprintf(stderr, "dumpet: cannot edit standard input\n");
+			exit(2);
+		}
+		context.iso = stdin;
+	} else {
+		context.iso = fopen(context.filename, editing ? "r+" : "r");
+	}
 	if (!context.iso) {
 		fprintf(stderr, "Could not open \"%s\": %m\n", context.filename);
 		exit(2);
 	}
 
-	if (context.dumpXml) {
-		xml = xmlBufferCreate();
-		if (!xml) {
-			fprintf(stderr, "Error creating XML buffer: %m\n");
-			exit(3);
+	/* a pipe can only be read forward */
+	if (lseek(fileno(context.iso), 0, SEEK_CUR) < 0 && errno == ESPIPE) {
+		const char *needs = editing ? "editing" :
+				    context.scan ? "--scan" :
+				    context.mediaCheck ? "--mediacheck" :
+				    context.blessed ? "--blessed" :
+				    context.listPartitions ? "--partitions" :
+				    context.npartitions ? "--partition" : NULL;
+
+		if (needs) {
+			fprintf(stderr, "dumpet: %s needs a seekable image\n",
+				needs);
+			exit(2);
 		}
-		context.writer = xmlNewTextWriterMemory(xml, 0);
-		if (!context.writer) {
-			fprintf(stderr, "Error creating XML writer\n");
+		input_stream = stream_open(context.iso);
+		if (!input_stream) {
+			fprintf(stderr, "dumpet: %m\n");
 			exit(3);
 		}
-		rc = xmlTextWriterStartDocument(context.writer, NULL, "UTF-8", NULL);
-		if (rc < 0) {
-			fprintf(stderr, "Error starting new XML document\n");
-			exit(3);
-		}
-		rc = xmlTextWriterStartElement(context.writer, BAD_CAST "ElToritoBootCatalog");
-		if (rc < 0) {
-			fprintf(stderr, "Error creating element \"El-Torito\"\n");
-			exit(3);
-		}
-	} else {
-		context.dumpStdOut = 1;
 	}
 
+	if (context.hexdumpRange) {
+		rc = dumpHexRange(&context);
+		close_image(&context);
+		free(context.filename);
+		free(context.hexdumpRange);
+		poptFreeContext(optCon);
+		return rc;
+	}
+
+	if (context.probe) {
+		rc = probe_image(&context);
+		close_image(&context);
+		free(context.filename);
+		poptFreeContext(optCon);
+		return rc;
+	}
+
+	if (context.lint) {
+		rc = lint_image(&context);
+		close_image(&context);
+		free(context.filename);
+		poptFreeContext(optCon);
+		return rc;
+	}
+
+	if (context.blessed) {
+		rc = dump_blessed(&context);
+		close_image(&context);
+		free(context.filename);
+		poptFreeContext(optCon);
+		return rc;
+	}
+
+	if (context.listPartitions || context.npartitions) {
+		if (context.listPartitions)
+			rc = list_partitions(&context);
+		else
+			rc = extract_partitions(&context);
+		close_image(&context);
+		free(context.filename);
+		for (i = 0; i < context.npartitions; i++)
+			free(context.partitions[i]);
+		free(context.partitions);
+		poptFreeContext(optCon);
+		return rc;
+	}
+
+	if (context.mediaCheck) {
+		rc = check_media(&context);
+		close_image(&context);
+		free(context.filename);
+		poptFreeContext(optCon);
+		return rc;
+	}
+
+	if (context.scan) {
+		rc = scan_image(&context);
+		close_image(&context);
+		free(context.filename);
+		poptFreeContext(optCon);
+		return rc;
+	}
+
+	for (i = 0; i < noutputs; i++) {
+		if (add_renderer(&context, outputs[i]) < 0)
+			exit(2);
+		free(outputs[i]);
+	}
+	free(outputs);
+	if (context.dumpXml && add_renderer(&context, "xml") < 0)
+		exit(2);
+	if (!context.renderers && add_renderer(&context, "text") < 0)
+		exit(2);
+
 	rc = dumpet(&context);
-	
-	fclose(context.iso);
+	if (finish_renderers(&context) < 0 && rc == 0)
+		rc = 3;
+
+	close_image(&context);
 	free(context.filename);
+	free(context.storeDir);
+	for (i = 0; i < context.nedits; i++)
+		free(context.edits[i]);
+	free(context.edits);
+	for (i = 0; i < context.nreplacements; i++)
+		free(context.replacements[i]);
+	free(context.replacements);
 
 	poptFreeContext(optCon);
 
-	if (context.dumpXml) {
-		rc = xmlTextWriterEndElement(context.writer);
-		rc = xmlTextWriterEndDocument(context.writer);
-		xmlFreeTextWriter(context.writer);
-		printf("%s", xml->content);
-		xmlBufferFree(xml);
-	}
-
 	return rc;
 }
 
@@ -21,9 +21,57 @@
 #define DUMPET_H
 
 #include <errno.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "iso9660.h"
 #include "eltorito.h"
+#include "stats.h"
+#include "stream.h"
+
+struct renderer;
+struct descriptor_set;
+
+struct context {
+	int dumpDiskImage;
+	int dumpHex;
+	int dumpXml;
+	int base64;
+	int stats;
+	char *hexdumpRange;
+	char *storeDir;
+	int scan;
+	int lint;
+	int blessed;
+	int mediaCheck;
+	int probe;
+	int classify;
+	int authenticode;
+	int bootInfo;
+	int dumpVolume;
+	int threads;
+	int fixChecksum;
+	char **edits;
+	int nedits;
+	char **replacements;
+	int nreplacements;
+	int listPartitions;
+	char **partitions;
+	int npartitions;
+
+	struct renderer *renderers;
+	struct descriptor_set *volume;
+	struct file_map *files;	/* read from volume when first needed */
+	char *filename;
+	FILE *iso;
+};
+
+/* What files written next to the image are named after; "-" would make
+ * "-.0", so standard input gets a name of its own. */
+static inline const char *output_prefix(struct context *context)
+{
+	return strcmp(context->filename, "-") ? context->filename : "stdin";
+}
 
 static inline off_t get_sector_offset(int sector_number)
 {
@@ -31,35 +79,132 @@ static inline off_t get_sector_offset(int sector_number)
 	return sector_number * sizeof(sector);
 }
 	
-static inline int read_sector(FILE *iso, int sector_number, Sector *sector)
+/* Seek and read, or with a forward-only input, get the sectors from the
+ * stream.  Returns the number of whole sectors read; *error is set if
+ * that's short for any reason other than the end of the image. */
+static inline size_t fetch_sectors(FILE *iso, int sector_number, int count,
+				   Sector *sectors, int *error)
 {
 	size_t n;
+
+	if (input_stream) {
+		n = stream_read(input_stream, sector_number, count, sectors);
+		*error = input_stream->error != 0;
+		return n;
+	}
+
 	fseek(iso, get_sector_offset(sector_number), SEEK_SET);
-	n = fread(sector, sizeof(*sector), 1, iso);
+	n = fread(sectors, sizeof(*sectors), count, iso);
+
+	iostats.seeks++;
+	iostats.reads++;
+	iostats.bytes_read += n * sizeof(*sectors);
+	*error = ferror(iso);
+	return n;
+}
+
+static inline int read_sectors(FILE *iso, int sector_number, int count,
+				Sector *sectors)
+{
+	size_t n;
+	int error;
+
+	n = fetch_sectors(iso, sector_number, count, sectors, &error);
+	dumpet_probe3(read_sector, sector_number, count, n == count ? 0 : -1);
+
+	if (n != count) {
+		/* a short read with no error is the end of the image, which
+		 * leaves errno alone */
+		int errnum = !error ? ENODATA : errno ? errno : EIO;
+
+		if (error)
+			fprintf(stderr, "dumpet: Error reading image: %s\n",
+				strerror(errnum));
+		else
+			fprintf(stderr, "dumpet: Error reading image: sector "
+				"%zu is past its end\n", sector_number + n);
+		errno = errnum;
+		return -errnum;
+	}
+	return 0;
+}
+
+/* Like read_sectors(), but running into the end of the image isn't an
+ * error; returns the number of whole sectors read. */
+static inline int read_sectors_upto(FILE *iso, int sector_number, int count,
+				    Sector *sectors)
+{
+	size_t n;
+	int error;
+
+	n = fetch_sectors(iso, sector_number, count, sectors, &error);
+	dumpet_probe3(read_sector, sector_number, count, error ? -1 : 0);
 
-	if (n != 1) {
+	if (n != count && error) {
 		int errnum = errno;
 		fprintf(stderr, "dumpet: Error reading image: %m\n");
 		errno = errnum;
 		return -errno;
 	}
-	return 0;
+	return n;
 }
 
-static inline int write_sector(FILE *iso, int sector_number, Sector *sector)
+static inline int read_sector(FILE *iso, int sector_number, Sector *sector)
+{
+	return read_sectors(iso, sector_number, 1, sector);
+}
+
+static inline int write_sectors(FILE *iso, int sector_number, int count,
+				Sector *sectors)
 {
 	size_t n;
 	fseek(iso, get_sector_offset(sector_number), SEEK_SET);
-	n = fwrite(sector, sizeof(*sector), 1, iso);
+	n = fwrite(sectors, sizeof(*sectors), count, iso);
+
+	iostats.seeks++;
+	iostats.writes++;
+	iostats.bytes_written += n * sizeof(*sectors);
+	dumpet_probe3(write_sector, sector_number, count, n == count ? 0 : -1);
 
-	if (n != 1) {
+	if (n != count) {
 		int errnum = errno;
 		fprintf(stderr, "dumpet: Error writing image: %m\n");
 		errno = errnum;
 		return -errno;
 	}
 	return 0;
+}
+
+static inline int write_sector(FILE *iso, int sector_number, Sector *sector)
+{
+	return write_sectors(iso, sector_number, 1, sector);
+}
+
+/* Write a sector back in place with a single positioned write, and don't
+ * return until it's on stable storage. */
+static inline int write_sector_sync(FILE *iso, int sector_number,
+				    Sector *sector)
+{
+	ssize_t n;
+
+	fflush(iso);
+	n = pwrite(fileno(iso), sector, sizeof(*sector),
+		   get_sector_offset(sector_number));
+
+	iostats.writes++;
+	if (n > 0)
+		iostats.bytes_written += n;
+	dumpet_probe3(write_sector, sector_number, 1,
+		      n == sizeof(*sector) ? 0 : -1);
 
+	if (n != sizeof(*sector) || fsync(fileno(iso)) < 0) {
+		int errnum = n < 0 || n == sizeof(*sector) ? errno : EIO;
+		errno = errnum;
+		fprintf(stderr, "dumpet: Error writing image: %m\n");
+		errno = errnum;
+		return -errno;
+	}
+	return 0;
 }
 
 #endif /* DUMPET_H */
@@ -20,6 +20,7 @@
 #define ENDIAN_H
 
 #include <endian.h>
+#include <byteswap.h>
 
 #if __BYTE_ORDER == __LITTLE_ENDIAN
 #define cpu_to_le16(x) (x)
@@ -0,0 +1,438 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#include <errno.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "fat.h"
+#include "endian.h"
+
+#define FAT_MAX_DEPTH 16
+#define FAT_MAX_DIR_SIZE (65536 * 32)	/* the most entries a directory has */
+#define FAT_MAX_PATH 256
+
+static inline uint16_t get_le16(const uint8_t *p)
+{
+	uint16_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return le16_to_cpu(v);
+}
+
+static inline uint32_t get_le32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return le32_to_cpu(v);
+}
+
+int fat_open(struct fat *fat, struct byte_source *src)
+{
+	uint8_t bs[512];
+	uint32_t bps, spc, reserved, nfats, root_entries;
+	uint32_t total, fatsz, root_sectors, data_start, needed;
+	ssize_t rc;
+
+	memset(fat, '\0', sizeof(*fat));
+	fat->src = src;
+
+	rc = source_read(src, 0, bs, sizeof(bs));
+	if (rc < 0)
+		return rc;
+	if (rc < sizeof(bs) || (bs[0] != 0xeb && bs[0] != 0xe9))
+		return -EINVAL;
+
+	bps = get_le16(bs + 11);
+	spc = bs[13];
+	reserved = get_le16(bs + 14);
+	nfats = bs[16];
+	root_entries = get_le16(bs + 17);
+	total = get_le16(bs + 19) ? get_le16(bs + 19) : get_le32(bs + 32);
+	fatsz = get_le16(bs + 22) ? get_le16(bs + 22) : get_le32(bs + 36);
+
+	if (bps < 512 || bps > 4096 || (bps & (bps - 1)) ||
+			!spc || (spc & (spc - 1)) || !reserved || !nfats ||
+			!total || !fatsz)
+		return -EINVAL;
+
+	root_sectors = (root_entries * 32 + bps - 1) / bps;
+	data_start = reserved + nfats * fatsz + root_sectors;
+	if (data_start >= total)
+		return -EINVAL;
+
+	/* the cluster count alone decides which FAT this is */
+	fat->cluster_size = bps * spc;
+	fat->nclusters = (total - data_start) / spc;
+	if (fat->nclusters < 4085) {
+		fat->bits = 12;
+		needed = (fat->nclusters + 2) * 3 / 2 + 1;
+	} else if (fat->nclusters < 65525) {
+		fat->bits = 16;
+		needed = (fat->nclusters + 2) * 2;
+	} else {
+		fat->bits = 32;
+		needed = (fat->nclusters + 2) * 4;
+		fat->root_cluster = get_le32(bs + 44);
+		if (root_entries || fat->root_cluster < 2)
+			return -EINVAL;
+	}
+	fat->data_offset = (uint64_t)data_start * bps;
+	fat->root_offset = (uint64_t)(reserved + nfats * fatsz) * bps;
+	fat->root_size = root_entries * 32;
+
+	fat->table_size = (uint64_t)fatsz * bps < needed ? fatsz * bps : needed;
+	fat->table = malloc(fat->table_size);
+	if (!fat->table)
+		return -errno;
+	rc = source_read(src, (uint64_t)reserved * bps, fat->table,
+			 fat->table_size);
+	if (rc < 0 || rc < fat->table_size) {
+		fat_close(fat);
+		return rc < 0 ? rc : -EINVAL;
+	}
+	return 0;
+}
+
+void fat_close(struct fat *fat)
+{
+	free(fat->table);
+	fat->table = NULL;
+}
+
+/* The cluster after this one in its chain, or 0 at the end of the chain
+ * or if the chain is broken. */
+static uint32_t fat_next(struct fat *fat, uint32_t cluster)
+{
+	uint32_t next;
+
+	if (cluster < 2 || cluster >= fat->nclusters + 2)
+		return 0;
+
+	switch (fat->bits) {
+		case 12:
+			if (cluster + cluster / 2 + 2 > fat->table_size)
+				return 0;
+			next = get_le16(fat->table + cluster + cluster / 2);
+			next = cluster & 1 ? next >> 4 : next & 0xfff;
+			break;
+		case 16:
+			if (cluster * 2 + 2 > fat->table_size)
+				return 0;
+			next = get_le16(fat->table + cluster * 2);
+			break;
+		default:
+			if (cluster * 4 + 4 > fat->table_size)
+				return 0;
+			next = get_le32(fat->table + cluster * 4) & 0x0fffffff;
+			break;
+	}
+	if (next < 2 || next >= fat->nclusters + 2)
+		return 0;
+	return next;
+}
+
+static ssize_t fat_file_read(struct byte_source *src, uint64_t offset,
+			     void *buf, size_t len)
+{
+	struct fat_file *file = (struct fat_file *)src;
+	struct fat *fat = file->fat;
+	uint32_t cs = fat->cluster_size;
+	size_t done = 0;
+
+	while (done < len) {
+		uint32_t index = (offset + done) / cs;
+		uint32_t within = (offset + done) % cs;
+		uint32_t c, run;
+		size_t n;
+		ssize_t rc;
+
+		if (index < file->index) {
+			file->index = 0;
+			file->cluster = file->first;
+		}
+		while (file->index < index) {
+			uint32_t next = fat_next(fat, file->cluster);
+
+			if (!next)
+				return done;
+			file->cluster = next;
+			file->index++;
+		}
+		if (file->cluster < 2)
+			return done;
+
+		/* read straight through clusters that follow on disk */
+		for (c = file->cluster, run = 1;
+				(uint64_t)run * cs - within < len - done;
+				run++) {
+			uint32_t next = fat_next(fat, c);
+
+			if (next != c + 1)
+				break;
+			c = next;
+		}
+		n = (uint64_t)run * cs - within;
+		if (n > len - done)
+			n = len - done;
+
+		rc = source_read(fat->src, fat->data_offset +
+				 (uint64_t)(file->cluster - 2) * cs + within,
+				 (uint8_t *)buf + done, n);
+		if (rc < 0)
+			return rc;
+		done += rc;
+		index = (offset + done - 1) / cs;
+		file->cluster += index - file->index;
+		file->index = index;
+		if (rc < n)
+			break;
+	}
+	return done;
+}
+
+void fat_file_open(struct fat *fat, struct fat_file *file, uint32_t cluster,
+		   uint32_t size)
+{
+	file->src.read = fat_file_read;
+	file->src.size = size;
+	file->fat = fat;
+	file->first = cluster;
+	file->index = 0;
+	file->cluster = cluster;
+}
+
+/* Read a whole directory; cluster 0 is the FAT12/16 root. */
+static int read_dir(struct fat *fat, uint32_t cluster, uint8_t **bufp,
+		    size_t *lenp)
+{
+	struct fat_file dir;
+	uint8_t *buf;
+	ssize_t rc;
+
+	if (cluster == 0 && fat->bits != 32) {
+		buf = malloc(fat->root_size);
+		if (!buf)
+			return -errno;
+		rc = source_read(fat->src, fat->root_offset, buf,
+				 fat->root_size);
+	} else {
+		if (cluster == 0)
+			cluster = fat->root_cluster;
+		buf = malloc(FAT_MAX_DIR_SIZE);
+		if (!buf)
+			return -errno;
+		/* the chain's end is the directory's end */
+		fat_file_open(fat, &dir, cluster, FAT_MAX_DIR_SIZE);
+		rc = source_read(&dir.src, 0, buf, FAT_MAX_DIR_SIZE);
+	}
+	if (rc < 0) {
+		free(buf);
+		return rc;
+	}
+	*bufp = buf;
+	*lenp = rc;
+	return 0;
+}
+
+static uint8_t lfn_checksum(const uint8_t *name)
+{
+	uint8_t sum = 0;
+	int i;
+
+	for (i = 0; i < 11; i++)
+		sum = ((sum & 1) << 7) + (sum >> 1) + name[i];
+	return sum;
+}
+
+static void short_name(const uint8_t *e, char *name)
+{
+	int i, n = 0, len;
+
+	for (len = 8; len > 0 && e[len - 1] == ' '; len--)
+		;
+	for (i = 0; i < len; i++) {
+		char ch = i == 0 && e[0] == 0x05 ? 0xe5 : e[i];
+
+		name[n++] = e[12] & 0x08 ? tolower(ch) : ch;
+	}
+	for (len = 3; len > 0 && e[8 + len - 1] == ' '; len--)
+		;
+	if (len)
+		name[n++] = '.';
+	for (i = 0; i < len; i++)
+		name[n++] = e[12] & 0x10 ? tolower(e[8 + i]) : e[8 + i];
+	name[n] = '\0';
+}
+
+/* UCS-2 from the long name entries, as UTF-8 */
+static void long_name(const uint16_t *lfn, char *name, size_t size)
+{
+	size_t n = 0;
+	int i;
+
+	for (i = 0; i < 260 && lfn[i] && lfn[i] != 0xffff; i++) {
+		uint16_t ch = lfn[i];
+
+		if (n + 4 > size)
+			break;
+		if (ch < 0x80) {
+			name[n++] = ch;
+		} else if (ch < 0x800) {
+			name[n++] = 0xc0 | ch >> 6;
+			name[n++] = 0x80 | (ch & 0x3f);
+		} else {
+			name[n++] = 0xe0 | ch >> 12;
+			name[n++] = 0x80 | ((ch >> 6) & 0x3f);
+			name[n++] = 0x80 | (ch & 0x3f);
+		}
+	}
+	name[n] = '\0';
+}
+
+struct walk {
+	fat_walk_fn fn;
+	void *priv;
+	uint8_t *seen;		/* a bit for each directory's first cluster */
+	uint32_t nseen;
+};
+
+/* A directory can lead back to one already walked, or to one that's in
+ * another directory too, and would be walked again every time. */
+static int seen_before(struct walk *walk, uint32_t cluster)
+{
+	uint8_t bit = 1 << (cluster % 8);
+
+	if (cluster >= walk->nseen)
+		return 0;
+	if (walk->seen[cluster / 8] & bit)
+		return 1;
+	walk->seen[cluster / 8] |= bit;
+	return 0;
+}
+
+static int walk_dir(struct fat *fat, uint32_t cluster, char *path,
+		    size_t pathlen, int depth, struct walk *walk)
+{
+	static const int lfn_chars[13] = {
+		1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30
+	};
+	uint16_t lfn[260];
+	uint8_t lfn_sum = 0;
+	int have_lfn = 0;
+	uint8_t *buf = NULL;
+	size_t len = 0, off;
+	int rc;
+
+	if (seen_before(walk, cluster ? cluster : fat->root_cluster))
+		return 0;
+	rc = read_dir(fat, cluster, &buf, &len);
+	if (rc < 0)
+		return rc;
+
+	for (off = 0, rc = 0; off + 32 <= len && rc == 0; off += 32) {
+		const uint8_t *e = buf + off;
+		char name[FAT_MAX_PATH];
+		uint32_t first;
+		int i;
+
+		if (e[0] == 0x00)
+			break;
+		if (e[0] == 0xe5) {
+			have_lfn = 0;
+			continue;
+		}
+
+		if ((e[11] & 0x3f) == 0x0f) {
+			int seq = e[0] & 0x1f;
+
+			if (e[0] & 0x40) {
+				memset(lfn, '\0', sizeof(lfn));
+				lfn_sum = e[13];
+				have_lfn = 1;
+			}
+			if (!have_lfn || e[13] != lfn_sum || seq < 1 ||
+					seq > 20) {
+				have_lfn = 0;
+				continue;
+			}
+			for (i = 0; i < 13; i++)
+				lfn[(seq - 1) * 13 + i] =
+					get_le16(e + lfn_chars[i]);
+			continue;
+		}
+		if (e[11] & 0x08) {		/* volume label */
+			have_lfn = 0;
+			continue;
+		}
+
+		if (have_lfn && lfn_checksum(e) == lfn_sum)
+			long_name(lfn, name, sizeof(name));
+		else
+			short_name(e, name);
+		have_lfn = 0;
+		if (!strcmp(name, ".") || !strcmp(name, "..") ||
+				pathlen + strlen(name) + 2 > FAT_MAX_PATH)
+			continue;
+
+		sprintf(path + pathlen, "/%s", name);
+		first = get_le16(e + 26);
+		if (fat->bits == 32)
+			first |= (uint32_t)get_le16(e + 20) << 16;
+		if (e[11] & 0x10) {
+			if (depth < FAT_MAX_DEPTH && first >= 2)
+				rc = walk_dir(fat, first, path,
+					      pathlen + strlen(name) + 1,
+					      depth + 1, walk);
+		} else {
+			rc = walk->fn(fat, path, first, get_le32(e + 28),
+				      walk->priv);
+		}
+		path[pathlen] = '\0';
+	}
+	free(buf);
+	return rc;
+}
+
+int fat_walk(struct fat *fat, fat_walk_fn fn, void *priv)
+{
+	struct walk walk = { .fn = fn, .priv = priv };
+	char path[FAT_MAX_PATH] = "";
+	uint64_t n = fat->nclusters, data = 0;
+	int rc;
+
+	/* clusters past the end of the image can't hold a directory */
+	if (fat->src->size > fat->data_offset)
+		data = fat->src->size - fat->data_offset;
+	if ((data + fat->cluster_size - 1) / fat->cluster_size < n)
+		n = (data + fat->cluster_size - 1) / fat->cluster_size;
+	n += 2;
+	walk.nseen = n;
+	walk.seen = calloc((n + 7) / 8, 1);
+	if (!walk.seen)
+		return -errno;
+
+	rc = walk_dir(fat, 0, path, 0, 0, &walk);
+	free(walk.seen);
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FAT_H
+#define FAT_H
+
+#include <stdint.h>
+
+#include "source.h"
+
+/* Just enough of FAT12/16/32 to find the files in an EFI system partition
+ * image and read them in place. */
+
+struct fat {
+	struct byte_source *src;
+	int bits;			/* 12, 16 or 32 */
+	uint32_t cluster_size;		/* in bytes */
+	uint32_t nclusters;
+	uint64_t data_offset;		/* of cluster 2 */
+	uint64_t root_offset;		/* FAT12/16 fixed root directory */
+	uint32_t root_size;
+	uint32_t root_cluster;		/* FAT32 */
+	uint8_t *table;			/* the first FAT */
+	uint32_t table_size;
+};
+
+/* A file inside the file system, readable as a source of its own. */
+struct fat_file {
+	struct byte_source src;
+	struct fat *fat;
+	uint32_t first;
+	uint32_t index;			/* cluster number within the file... */
+	uint32_t cluster;		/* ... of this cluster */
+};
+
+typedef int (*fat_walk_fn)(struct fat *fat, const char *path,
+			   uint32_t cluster, uint32_t size, void *priv);
+
+/* Returns 0, -EINVAL if src doesn't hold a FAT file system, or -errno. */
+extern int fat_open(struct fat *fat, struct byte_source *src);
+extern void fat_close(struct fat *fat);
+extern void fat_file_open(struct fat *fat, struct fat_file *file,
+			  uint32_t cluster, uint32_t size);
+
+/* Call fn for every regular file, depth first, with its full path.  A
+ * nonzero return from fn stops the walk and is returned. */
+extern int fat_walk(struct fat *fat, fat_walk_fn fn, void *priv);
+
+#endif /* FAT_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
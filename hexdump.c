@@ -0,0 +1,161 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "hexdump.h"
+
+/* One output line is at most 16 offset digits, two spaces, 16 "xx ",
+ * " |", 16 characters and "|\n". */
+#define MAX_LINE (16 + 2 + 48 + 2 + 16 + 2)
+
+static const char hexdigits[16] = "0123456789abcdef";
+
+/* hexpairs[2*b] and hexpairs[2*b+1] are the two digits for byte b. */
+static char hexpairs[512];
+/* what to show in the character column; dumpHex() has always shown
+ * only alphanumerics. */
+static char printable[256];
+static int tables_ready;
+
+static void init_tables(void)
+{
+	int i;
+
+	for (i = 0; i < 256; i++) {
+		hexpairs[2*i] = hexdigits[i >> 4];
+		hexpairs[2*i+1] = hexdigits[i & 0xf];
+		if ((i >= '0' && i <= '9') || (i >= 'a' && i <= 'z') ||
+				(i >= 'A' && i <= 'Z'))
+			printable[i] = i;
+		else
+			printable[i] = '.';
+	}
+	tables_ready = 1;
+}
+
+static int write_all(int fd, const char *buf, size_t len)
+{
+	while (len) {
+		ssize_t n = write(fd, buf, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		buf += n;
+		len -= n;
+	}
+	return 0;
+}
+
+int hexdump_flush(struct hexdump *hd)
+{
+	int rc = write_all(hd->fd, hd->buf, hd->used);
+	hd->used = 0;
+	return rc;
+}
+
+static char *format_offset(char *p, uint64_t offset)
+{
+	int digits = 8;
+	int i;
+
+	if (offset >> 32) {
+		while (digits < 16 && offset >> (digits * 4))
+			digits++;
+	}
+	for (i = digits - 1; i >= 0; i--)
+		*p++ = hexdigits[(offset >> (i * 4)) & 0xf];
+	return p;
+}
+
+static char *format_line(char *p, const uint8_t *data, size_t n,
+			 uint64_t offset)
+{
+	size_t i;
+
+	p = format_offset(p, offset);
+	*p++ = ' ';
+	*p++ = ' ';
+	for (i = 0; i < n; i++) {
+		memcpy(p, &hexpairs[2 * data[i]], 2);
+		p[2] = ' ';
+		p += 3;
+	}
+	for (; i < 16; i++) {
+		memcpy(p, "   ", 3);
+		p += 3;
+	}
+	*p++ = ' ';
+	*p++ = '|';
+	for (i = 0; i < n; i++)
+		*p++ = printable[data[i]];
+	*p++ = '|';
+	*p++ = '\n';
+	return p;
+}
+
+int hexdump_add(struct hexdump *hd, const void *voiddata, size_t length)
+{
+	const uint8_t *data = voiddata;
+	int rc;
+
+	if (!tables_ready)
+		init_tables();
+
+	while (length) {
+		size_t n = length < 16 ? length : 16;
+		char *end;
+
+		if (hd->used + MAX_LINE > sizeof(hd->buf)) {
+			rc = hexdump_flush(hd);
+			if (rc < 0)
+				return rc;
+		}
+		end = format_line(hd->buf + hd->used, data, n, hd->offset);
+		hd->used = end - hd->buf;
+		hd->offset += n;
+		data += n;
+		length -= n;
+	}
+	return 0;
+}
+
+int hexdump_fd(int fd, const void *data, size_t length, uint64_t offset)
+{
+	struct hexdump *hd;
+	int rc;
+
+	hd = malloc(sizeof(*hd));
+	if (!hd)
+		return -errno;
+	hd->fd = fd;
+	hd->offset = offset;
+	hd->used = 0;
+
+	rc = hexdump_add(hd, data, length);
+	if (rc >= 0)
+		rc = hexdump_flush(hd);
+	free(hd);
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
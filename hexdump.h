@@ -0,0 +1,40 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HEXDUMP_H
+#define HEXDUMP_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+struct hexdump {
+	int fd;
+	uint64_t offset;	/* offset printed for the next byte */
+	size_t used;
+	char buf[65536];
+};
+
+/* Format "length" bytes of "data" into the hexdump's buffer, 16 bytes per
+ * line, writing the buffer to hd->fd whenever it fills.  Lengths that are
+ * not a multiple of 16 should only be given for the last chunk. */
+extern int hexdump_add(struct hexdump *hd, const void *data, size_t length);
+extern int hexdump_flush(struct hexdump *hd);
+
+extern int hexdump_fd(int fd, const void *data, size_t length,
+		      uint64_t offset);
+
+#endif /* HEXDUMP_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#include <errno.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hfsplus.h"
+#include "endian.h"
+
+#define HFS_MAX_DEPTH 16	/* of the B-tree */
+#define HFS_MAX_PATH_DEPTH 256	/* of the folder hierarchy */
+
+/* B-tree node kinds */
+#define kBTLeafNode	-1
+#define kBTIndexNode	0
+#define kBTHeaderNode	1
+
+#define kBTBigKeysMask			0x00000002
+#define kBTVariableIndexKeysMask	0x00000004
+
+/* catalog record types */
+#define kHFSPlusFolderThreadRecord	3
+#define kHFSPlusFileThreadRecord	4
+
+static inline uint16_t get_be16(const uint8_t *p)
+{
+	uint16_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return be16_to_cpu(v);
+}
+
+static inline uint32_t get_be32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return be32_to_cpu(v);
+}
+
+static inline uint64_t get_be64(const uint8_t *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return be64_to_cpu(v);
+}
+
+/* Read from a fork through its extents; returns the number of bytes read,
+ * short if the extents run out first, or -errno. */
+static ssize_t fork_read(struct hfsplus *hfs, struct hfs_fork *fork,
+			 uint64_t offset, void *buf, size_t len)
+{
+	uint64_t pos = 0;
+	size_t done = 0;
+	int i;
+
+	for (i = 0; i < 8 && done < len; i++) {
+		uint64_t bytes = (uint64_t)fork->extents[i].count *
+				 hfs->block_size;
+		uint64_t within;
+		size_t n;
+		ssize_t rc;
+
+		if (offset + done >= pos + bytes) {
+			pos += bytes;
+			continue;
+		}
+		within = offset + done - pos;
+		n = bytes - within < len - done ? bytes - within : len - done;
+		rc = source_read(hfs->src, hfs->offset +
+				 (uint64_t)fork->extents[i].start *
+				 hfs->block_size + within,
+				 (uint8_t *)buf + done, n);
+		if (rc < 0)
+			return rc;
+		done += rc;
+		if (rc < n)
+			break;
+		pos += bytes;
+	}
+	return done;
+}
+
+static void read_fork_data(struct hfs_fork *fork, const uint8_t *p)
+{
+	int i;
+
+	fork->size = get_be64(p);
+	for (i = 0; i < 8; i++) {
+		fork->extents[i].start = get_be32(p + 16 + i * 8);
+		fork->extents[i].count = get_be32(p + 20 + i * 8);
+	}
+}
+
+int hfsplus_open(struct hfsplus *hfs, struct byte_source *src)
+{
+	uint8_t vh[512], hdr[512];
+	uint64_t extent_bytes = 0;
+	ssize_t rc;
+	int i;
+
+	memset(hfs, '\0', sizeof(*hfs));
+	hfs->src = src;
+
+	rc = source_read(src, 1024, vh, sizeof(vh));
+	if (rc < 0)
+		return rc;
+	if (rc < sizeof(vh))
+		return -EINVAL;
+
+	/* an HFS wrapper with the real volume embedded in it */
+	if (get_be16(vh) == HFS_SIGNATURE) {
+		if (get_be16(vh + 124) != HFSPLUS_SIGNATURE)
+			return -EINVAL;
+		hfs->offset = (uint64_t)get_be16(vh + 28) * 512 +
+			      (uint64_t)get_be16(vh + 126) * get_be32(vh + 20);
+		rc = source_read(src, hfs->offset + 1024, vh, sizeof(vh));
+		if (rc < 0)
+			return rc;
+		if (rc < sizeof(vh))
+			return -EINVAL;
+	}
+
+	hfs->signature = get_be16(vh);
+	if (hfs->signature != HFSPLUS_SIGNATURE &&
+			hfs->signature != HFSX_SIGNATURE)
+		return -EINVAL;
+	hfs->file_count = get_be32(vh + 32);
+	hfs->folder_count = get_be32(vh + 36);
+	hfs->block_size = get_be32(vh + 40);
+	hfs->total_blocks = get_be32(vh + 44);
+	if (hfs->block_size < 512 ||
+			(hfs->block_size & (hfs->block_size - 1)))
+		return -EINVAL;
+	for (i = 0; i < 8; i++)
+		hfs->finder_info[i] = get_be32(vh + 80 + i * 4);
+	read_fork_data(&hfs->catalog, vh + 272);
+
+	/* anything past eight extents is in the extents overflow file */
+	for (i = 0; i < 8; i++)
+		extent_bytes += (uint64_t)hfs->catalog.extents[i].count *
+				hfs->block_size;
+	if (extent_bytes < hfs->catalog.size)
+		return -EOPNOTSUPP;
+
+	/* node 0 is the header node, whatever the node size */
+	rc = fork_read(hfs, &hfs->catalog, 0, hdr, sizeof(hdr));
+	if (rc < 0)
+		return rc;
+	if (rc < sizeof(hdr) || (int8_t)hdr[8] != kBTHeaderNode)
+		return -EINVAL;
+	hfs->depth = get_be16(hdr + 14);
+	hfs->root_node = get_be32(hdr + 16);
+	hfs->node_size = get_be16(hdr + 32);
+	if (hfs->node_size < 512 || (hfs->node_size & (hfs->node_size - 1)) ||
+			(get_be32(hdr + 52) & (kBTBigKeysMask |
+					       kBTVariableIndexKeysMask)) !=
+			(kBTBigKeysMask | kBTVariableIndexKeysMask))
+		return -EINVAL;
+	return 0;
+}
+
+void hfsplus_close(struct hfsplus *hfs)
+{
+	int i;
+
+	for (i = 0; i < HFS_NODE_CACHE; i++) {
+		free(hfs->cache[i].data);
+		hfs->cache[i].data = NULL;
+	}
+}
+
+static int read_node(struct hfsplus *hfs, uint32_t node, const uint8_t **datap)
+{
+	struct hfs_cached_node *slot = &hfs->cache[0];
+	ssize_t rc;
+	int i;
+
+	hfs->clock++;
+	for (i = 0; i < HFS_NODE_CACHE; i++) {
+		struct hfs_cached_node *c = &hfs->cache[i];
+
+		if (c->data && c->node == node) {
+			c->used = hfs->clock;
+			*datap = c->data;
+			return 0;
+		}
+		if (!c->data || (slot->data && c->used < slot->used))
+			slot = c;
+	}
+
+	if (!slot->data) {
+		slot->data = malloc(hfs->node_size);
+		if (!slot->data)
+			return -errno;
+	}
+	rc = fork_read(hfs, &hfs->catalog, (uint64_t)node * hfs->node_size,
+		       slot->data, hfs->node_size);
+	if (rc < 0 || rc < hfs->node_size) {
+		free(slot->data);
+		slot->data = NULL;
+		return rc < 0 ? rc : -EINVAL;
+	}
+	slot->node = node;
+	slot->used = hfs->clock;
+	*datap = slot->data;
+	return 0;
+}
+
+/* Record i of a node, or NULL if the node's offsets don't make sense. */
+static const uint8_t *node_record(struct hfsplus *hfs, const uint8_t *node,
+				  int i, size_t *len)
+{
+	uint16_t nrecords = get_be16(node + 10);
+	uint32_t start, end;
+
+	if (i >= nrecords || 14 + 2 * (nrecords + 1) > hfs->node_size)
+		return NULL;
+	start = get_be16(node + hfs->node_size - 2 * (i + 1));
+	end = get_be16(node + hfs->node_size - 2 * (i + 2));
+	if (start < 14 || end < start ||
+			end > hfs->node_size - 2 * (nrecords + 1))
+		return NULL;
+	*len = end - start;
+	return node + start;
+}
+
+/* UTF-16BE to UTF-8; '/' is allowed in HFS+ names and shown as ':' the
+ * way the Finder and the BSD layer swap them. */
+static void unicode_name(const uint8_t *p, int nchars, char *name, size_t size)
+{
+	size_t n = 0;
+	int i;
+
+	for (i = 0; i < nchars; i++) {
+		uint32_t ch = get_be16(p + i * 2);
+
+		if (ch >= 0xd800 && ch < 0xdc00 && i + 1 < nchars) {
+			uint32_t lo = get_be16(p + i * 2 + 2);
+
+			if (lo >= 0xdc00 && lo < 0xe000) {
+				ch = 0x10000 + ((ch - 0xd800) << 10) +
+				     (lo - 0xdc00);
+				i++;
+			}
+		}
+		if (ch == '/')
+			ch = ':';
+
+		if (n + 5 > size)
+			break;
+		if (ch < 0x80) {
+			name[n++] = ch;
+		} else if (ch < 0x800) {
+			name[n++] = 0xc0 | ch >> 6;
+			name[n++] = 0x80 | (ch & 0x3f);
+		} else if (ch < 0x10000) {
+			name[n++] = 0xe0 | ch >> 12;
+			name[n++] = 0x80 | ((ch >> 6) & 0x3f);
+			name[n++] = 0x80 | (ch & 0x3f);
+		} else {
+			name[n++] = 0xf0 | ch >> 18;
+			name[n++] = 0x80 | ((ch >> 12) & 0x3f);
+			name[n++] = 0x80 | ((ch >> 6) & 0x3f);
+			name[n++] = 0x80 | (ch & 0x3f);
+		}
+	}
+	name[n] = '\0';
+}
+
+/* A thread record's key is the ID itself as the parent with an empty
+ * name, which sorts before every other key with that parent ID; so only
+ * parent IDs need comparing, and no case folding is involved. */
+static int compare_thread_key(const uint8_t *key, uint32_t cnid)
+{
+	uint32_t parent = get_be32(key + 2);
+
+	if (parent != cnid)
+		return parent < cnid ? -1 : 1;
+	return get_be16(key + 6) == 0 ? 0 : 1;
+}
+
+int hfsplus_thread(struct hfsplus *hfs, uint32_t cnid, uint32_t *parent,
+		   char *name, size_t size)
+{
+	uint32_t node = hfs->root_node;
+	int level;
+
+	for (level = 0; level < HFS_MAX_DEPTH; level++) {
+		const uint8_t *data = NULL, *rec, *best = NULL;
+		int i, rc, nrecords, cmp = 1;
+		size_t len, best_len = 0;
+		int8_t kind;
+
+		rc = read_node(hfs, node, &data);
+		if (rc < 0)
+			return rc;
+		kind = data[8];
+		nrecords = get_be16(data + 10);
+
+		for (i = 0; i < nrecords; i++) {
+			int c;
+
+			rec = node_record(hfs, data, i, &len);
+			if (!rec || len < 8 || get_be16(rec) < 6 ||
+					get_be16(rec) + 2 > len)
+				return -EINVAL;
+			c = compare_thread_key(rec, cnid);
+			if (c > 0)
+				break;
+			best = rec;
+			best_len = len;
+			cmp = c;
+		}
+		if (!best)
+			return -ENOENT;
+
+		if (kind == kBTIndexNode) {
+			uint16_t keylen = get_be16(best);
+
+			if (keylen + 2 + 4 > best_len)
+				return -EINVAL;
+			node = get_be32(best + 2 + keylen);
+		} else if (kind == kBTLeafNode) {
+			const uint8_t *d = best + 2 + get_be16(best);
+			size_t dlen = best_len - 2 - get_be16(best);
+			uint16_t type, nchars;
+
+			if (cmp != 0)
+				return -ENOENT;
+			if (dlen < 10)
+				return -EINVAL;
+			type = get_be16(d);
+			nchars = get_be16(d + 8);
+			if ((type != kHFSPlusFolderThreadRecord &&
+			     type != kHFSPlusFileThreadRecord) ||
+					10 + nchars * 2 > dlen)
+				return -EINVAL;
+			*parent = get_be32(d + 4);
+			unicode_name(d + 10, nchars, name, size);
+			return 0;
+		} else {
+			return -EINVAL;
+		}
+	}
+	return -EINVAL;
+}
+
+int hfsplus_path(struct hfsplus *hfs, uint32_t cnid, char *path, size_t size)
+{
+	size_t pos = size - 1;
+	char name[256 * 4 + 1];
+	int depth, rc;
+
+	path[pos] = '\0';
+	for (depth = 0; cnid != HFS_ROOT_FOLDER_ID; depth++) {
+		uint32_t parent;
+		size_t len;
+
+		if (depth == HFS_MAX_PATH_DEPTH)
+			return -EINVAL;
+		rc = hfsplus_thread(hfs, cnid, &parent, name, sizeof(name));
+		if (rc < 0)
+			return rc;
+		len = strlen(name);
+		if (len + 1 > pos)
+			return -ENAMETOOLONG;
+		pos -= len;
+		memcpy(path + pos, name, len);
+		path[--pos] = '/';
+		cnid = parent;
+	}
+	if (pos == size - 1)
+		path[--pos] = '/';
+	memmove(path, path + pos, size - pos);
+	return 0;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HFSPLUS_H
+#define HFSPLUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "source.h"
+
+/* Just enough of HFS+ (Apple TN1150) to turn a catalog node ID into a
+ * path: the volume header, and lookups of thread records in the catalog
+ * B-tree.  All on-disk fields are big endian. */
+
+#define HFSPLUS_SIGNATURE	0x482b	/* "H+" */
+#define HFSX_SIGNATURE		0x4858	/* "HX", case sensitive */
+#define HFS_SIGNATURE		0x4244	/* "BD", maybe with HFS+ inside */
+
+#define HFS_ROOT_PARENT_ID	1
+#define HFS_ROOT_FOLDER_ID	2
+
+/* Finder info words in the volume header that bless(8) sets */
+#define HFS_FINDER_BLESSED_FOLDER	0
+#define HFS_FINDER_BOOT_FILE		1
+#define HFS_FINDER_OS9_FOLDER		3
+#define HFS_FINDER_OSX_FOLDER		5
+
+struct hfs_extent {
+	uint32_t start;
+	uint32_t count;
+};
+
+struct hfs_fork {
+	uint64_t size;
+	struct hfs_extent extents[8];
+};
+
+/* Every lookup starts from the root node and most of them share the
+ * index nodes below it, so a few recently used nodes are kept. */
+#define HFS_NODE_CACHE 8
+
+struct hfs_cached_node {
+	uint32_t node;
+	uint32_t used;		/* when it was last used, for eviction */
+	uint8_t *data;		/* NULL if this slot is empty */
+};
+
+struct hfsplus {
+	struct byte_source *src;
+	uint64_t offset;	/* of the HFS+ volume, past any HFS wrapper */
+	uint16_t signature;
+	uint32_t block_size;
+	uint32_t total_blocks;
+	uint32_t file_count;
+	uint32_t folder_count;
+	uint32_t finder_info[8];
+	struct hfs_fork catalog;
+	uint32_t node_size;
+	uint32_t root_node;
+	uint16_t depth;
+	uint32_t clock;
+	struct hfs_cached_node cache[HFS_NODE_CACHE];
+};
+
+/* Returns 0, -EINVAL if src doesn't hold an HFS+ volume, or -errno. */
+extern int hfsplus_open(struct hfsplus *hfs, struct byte_source *src);
+extern void hfsplus_close(struct hfsplus *hfs);
+
+/* The parent and name of a file or folder, from its thread record.
+ * Returns 0, -ENOENT if there's no such ID, -EINVAL if the catalog is
+ * damaged, or -errno. */
+extern int hfsplus_thread(struct hfsplus *hfs, uint32_t cnid, uint32_t *parent,
+			  char *name, size_t size);
+
+/* The full path of a file or folder, "/" being the root folder. */
+extern int hfsplus_path(struct hfsplus *hfs, uint32_t cnid, char *path,
+			size_t size);
+
+#endif /* HFSPLUS_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,721 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "dumpet.h"
+#include "catalog.h"
+#include "endian.h"
+#include "index.h"
+#include "sha256.h"
+#include "volume.h"
+
+#define ALIGN8(x) (((x) + 7) & ~(uint64_t)7)
+
+/* The columns as they are collected, already little endian. */
+struct index_builder {
+	struct index_image *images;
+	uint32_t nimages;
+	char *strings;
+	size_t strings_size;
+	uint32_t nentries;
+	uint32_t cap;
+	uint8_t *platform;
+	uint8_t *media;
+	uint8_t *bootable;
+	uint32_t *lba;
+	uint16_t *sectors;
+	uint32_t *image;
+	uint8_t (*digest)[SHA256_DIGEST_SIZE];
+};
+
+#define grow(b, column) \
+	(((b)->column = realloc((b)->column, \
+				cap * sizeof(*(b)->column))) != NULL)
+
+static int grow_entries(struct index_builder *b, uint32_t need)
+{
+	uint32_t cap = b->cap ? b->cap : 256;
+
+	while (cap < need)
+		cap *= 2;
+	if (cap == b->cap)
+		return 0;
+	if (!grow(b, platform) || !grow(b, media) || !grow(b, bootable) ||
+			!grow(b, lba) || !grow(b, sectors) || !grow(b, image) ||
+			!grow(b, digest))
+		return -1;
+	b->cap = cap;
+	return 0;
+}
+
+#undef grow
+
+/* Hashed the way --store hashes an extracted image: as many sectors as
+ * belong to the entry, or as many as can be read.  An image that can't be
+ * read at all is left as zeros. */
+static void digest_entry(FILE *iso, struct file_map *map,
+			 struct boot_entry *entry,
+			 uint8_t digest[SHA256_DIGEST_SIZE])
+{
+	const uint32_t chunk = 64;
+	uint32_t sectors = boot_image_sectors(map, entry);
+	struct sha256_ctx ctx;
+	uint32_t done;
+	Sector *buf;
+	int n;
+
+	memset(digest, '\0', SHA256_DIGEST_SIZE);
+	if (!sectors)
+		return;
+	buf = malloc(chunk * sizeof(Sector));
+	if (!buf)
+		return;
+
+	sha256_init(&ctx);
+	for (done = 0; done < sectors; done += n) {
+		n = sectors - done < chunk ? sectors - done : chunk;
+		n = read_sectors_upto(iso, entry->LoadLBA + done, n, buf);
+		if (n <= 0)
+			break;
+		sha256_update(&ctx, buf, n * sizeof(Sector));
+	}
+	if (done)
+		sha256_final(&ctx, digest);
+	free(buf);
+}
+
+static int add_image(struct index_builder *b, const char *path)
+{
+	struct descriptor_set *set = NULL;
+	struct boot_catalog *cat = NULL;
+	struct file_map *map = NULL;
+	struct index_image *images;
+	size_t len = strlen(path) + 1;
+	char *strings;
+	FILE *iso;
+	int i, rc = 0;
+
+	iso = fopen(path, "r");
+	if (!iso) {
+		fprintf(stderr, "Could not open \"%s\": %m\n", path);
+		return 0;
+	}
+
+	set = malloc(sizeof(*set));
+	cat = malloc(sizeof(*cat));
+	if (!set || !cat)
+		goto nomem;
+
+	if (read_descriptor_set(iso, set) < 0 || set->boot_record < 0 ||
+			read_boot_catalog(iso, set->BootCatalogLBA, cat) < 0 ||
+			!cat->checksum_ok) {
+		fprintf(stderr, "dumpet: \"%s\" has no usable boot catalog; "
+			"left out\n", path);
+		goto out;
+	}
+
+	/* without it, images are hashed as far as the catalog says */
+	map = read_file_map(iso, set);
+
+	images = realloc(b->images, (b->nimages + 1) * sizeof(*images));
+	if (!images)
+		goto nomem;
+	b->images = images;
+	strings = realloc(b->strings, b->strings_size + len);
+	if (!strings)
+		goto nomem;
+	b->strings = strings;
+	if (grow_entries(b, b->nentries + cat->nentries) < 0)
+		goto nomem;
+
+	images[b->nimages].path = cpu32_to_iso731(b->strings_size);
+	images[b->nimages].first_entry = cpu32_to_iso731(b->nentries);
+	images[b->nimages].nentries = cpu32_to_iso731(cat->nentries);
+	images[b->nimages].catalog_lba = cpu32_to_iso731(cat->lba);
+	memcpy(b->strings + b->strings_size, path, len);
+	b->strings_size += len;
+
+	for (i = 0; i < cat->nentries; i++) {
+		struct boot_entry *entry = &cat->entries[i];
+		uint32_t e = b->nentries++;
+
+		b->platform[e] = entry->PlatformId;
+		b->media[e] = entry->BootMediaType;
+		b->bootable[e] = entry->BootIndicator == Bootable;
+		b->lba[e] = cpu32_to_iso731(entry->LoadLBA);
+		b->sectors[e] = cpu16_to_iso721(entry->SectorCount);
+		b->image[e] = cpu32_to_iso731(b->nimages);
+		digest_entry(iso, map, entry, b->digest[e]);
+	}
+	b->nimages++;
+	goto out;
+
+nomem:
+	fprintf(stderr, "dumpet: %m\n");
+	rc = -1;
+out:
+	free_file_map(map);
+	free(set);
+	free(cat);
+	fclose(iso);
+	return rc;
+}
+
+static int compare_lba(const void *a, const void *b, void *arg)
+{
+	struct index_builder *ib = arg;
+	uint32_t x = iso731_to_cpu32(*(const uint32_t *)a);
+	uint32_t y = iso731_to_cpu32(*(const uint32_t *)b);
+	uint32_t lx = iso731_to_cpu32(ib->lba[x]);
+	uint32_t ly = iso731_to_cpu32(ib->lba[y]);
+
+	if (lx != ly)
+		return lx < ly ? -1 : 1;
+	return x < y ? -1 : x > y;
+}
+
+static int compare_digest(const void *a, const void *b, void *arg)
+{
+	struct index_builder *ib = arg;
+	uint32_t x = iso731_to_cpu32(*(const uint32_t *)a);
+	uint32_t y = iso731_to_cpu32(*(const uint32_t *)b);
+	int rc = memcmp(ib->digest[x], ib->digest[y], SHA256_DIGEST_SIZE);
+
+	if (rc)
+		return rc;
+	return x < y ? -1 : x > y;
+}
+
+static uint32_t *sorted_entries(struct index_builder *b,
+				int (*compare)(const void *, const void *,
+					       void *))
+{
+	uint32_t *order = malloc((b->nentries ? b->nentries : 1) *
+				 sizeof(*order));
+	uint32_t e;
+
+	if (!order)
+		return NULL;
+	for (e = 0; e < b->nentries; e++)
+		order[e] = cpu32_to_iso731(e);
+	qsort_r(order, b->nentries, sizeof(*order), compare, b);
+	return order;
+}
+
+static int write_index(struct index_builder *b, const char *path)
+{
+	static const char zeros[8];
+	struct index_header hdr;
+	const void *data[IndexNumSections];
+	uint64_t sizes[IndexNumSections];
+	uint32_t *by_lba, *by_digest;
+	uint64_t offset;
+	char *tmp = NULL;
+	FILE *file = NULL;
+	int fd = -1, rc = 0;
+	int s;
+
+	by_lba = sorted_entries(b, compare_lba);
+	by_digest = sorted_entries(b, compare_digest);
+	if (!by_lba || !by_digest || asprintf(&tmp, "%s.XXXXXX", path) < 0) {
+		fprintf(stderr, "dumpet: %m\n");
+		rc = 3;
+		goto out;
+	}
+
+	data[IndexImages] = b->images;
+	sizes[IndexImages] = (uint64_t)b->nimages * sizeof(*b->images);
+	data[IndexStrings] = b->strings;
+	sizes[IndexStrings] = b->strings_size;
+	data[IndexPlatform] = b->platform;
+	sizes[IndexPlatform] = b->nentries;
+	data[IndexMedia] = b->media;
+	sizes[IndexMedia] = b->nentries;
+	data[IndexBootable] = b->bootable;
+	sizes[IndexBootable] = b->nentries;
+	data[IndexLBA] = b->lba;
+	sizes[IndexLBA] = (uint64_t)b->nentries * sizeof(*b->lba);
+	data[IndexSectors] = b->sectors;
+	sizes[IndexSectors] = (uint64_t)b->nentries * sizeof(*b->sectors);
+	data[IndexImage] = b->image;
+	sizes[IndexImage] = (uint64_t)b->nentries * sizeof(*b->image);
+	data[IndexDigest] = b->digest;
+	sizes[IndexDigest] = (uint64_t)b->nentries * sizeof(*b->digest);
+	data[IndexByLBA] = by_lba;
+	sizes[IndexByLBA] = (uint64_t)b->nentries * sizeof(*by_lba);
+	data[IndexByDigest] = by_digest;
+	sizes[IndexByDigest] = (uint64_t)b->nentries * sizeof(*by_digest);
+
+	memset(&hdr, '\0', sizeof(hdr));
+	memcpy(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic));
+	hdr.version = cpu32_to_iso731(INDEX_VERSION);
+	hdr.nimages = cpu32_to_iso731(b->nimages);
+	hdr.nentries = cpu32_to_iso731(b->nentries);
+	offset = ALIGN8(sizeof(hdr));
+	for (s = 0; s < IndexNumSections; s++) {
+		hdr.offsets[s] = cpu_to_le64(offset);
+		offset += ALIGN8(sizes[s]);
+	}
+	hdr.size = cpu_to_le64(offset);
+
+	/* written next to where it goes and renamed into place, so that a
+	 * query never sees half an index */
+	fd = mkstemp(tmp);
+	if (fd < 0 || !(file = fdopen(fd, "w"))) {
+		fprintf(stderr, "dumpet: Could not create \"%s\": %m\n", tmp);
+		if (fd >= 0) {
+			close(fd);
+			unlink(tmp);
+		}
+		rc = 3;
+		goto out;
+	}
+	fwrite(&hdr, 1, sizeof(hdr), file);
+	fwrite(zeros, 1, ALIGN8(sizeof(hdr)) - sizeof(hdr), file);
+	for (s = 0; s < IndexNumSections; s++) {
+		if (sizes[s])
+			fwrite(data[s], 1, sizes[s], file);
+		fwrite(zeros, 1, ALIGN8(sizes[s]) - sizes[s], file);
+	}
+	if (fchmod(fd, 0644) < 0 || ferror(file))
+		rc = 3;
+	if (fclose(file) != 0 || (rc == 0 && rename(tmp, path) < 0))
+		rc = 3;
+	if (rc) {
+		fprintf(stderr, "dumpet: Could not write \"%s\": %m\n", path);
+		unlink(tmp);
+	}
+out:
+	free(tmp);
+	free(by_lba);
+	free(by_digest);
+	return rc;
+}
+
+int build_index(const char *path, char **images, int nimages)
+{
+	struct index_builder b;
+	char *line = NULL;
+	size_t size = 0;
+	ssize_t len;
+	int i, rc = 0;
+
+	memset(&b, '\0', sizeof(b));
+	for (i = 0; i < nimages && rc == 0; i++)
+		if (add_image(&b, images[i]) < 0)
+			rc = 3;
+
+	/* a corpus is usually too big for one command line */
+	while (nimages == 0 && rc == 0 &&
+			(len = getline(&line, &size, stdin)) > 0) {
+		if (line[len - 1] == '\n')
+			line[--len] = '\0';
+		if (len && add_image(&b, line) < 0)
+			rc = 3;
+	}
+	free(line);
+
+	if (rc == 0)
+		rc = write_index(&b, path);
+
+	free(b.images);
+	free(b.strings);
+	free(b.platform);
+	free(b.media);
+	free(b.bootable);
+	free(b.lba);
+	free(b.sectors);
+	free(b.image);
+	free(b.digest);
+	return rc;
+}
+
+/* An index as mapped for querying. */
+struct index {
+	const uint8_t *map;
+	size_t size;
+	uint32_t nimages;
+	uint32_t nentries;
+	const struct index_image *images;
+	const char *strings;
+	size_t strings_size;
+	const uint8_t *platform;
+	const uint8_t *media;
+	const uint8_t *bootable;
+	const uint32_t *lba;
+	const uint16_t *sectors;
+	const uint32_t *image;
+	const uint8_t (*digest)[SHA256_DIGEST_SIZE];
+	const uint32_t *by_lba;
+	const uint32_t *by_digest;
+};
+
+static int map_index(struct index *ix, const char *path)
+{
+	const struct index_header *hdr;
+	uint64_t offsets[IndexNumSections + 1];
+	uint64_t lengths[IndexNumSections];
+	struct stat sb;
+	int fd, s;
+
+	memset(ix, '\0', sizeof(*ix));
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &sb) < 0) {
+		fprintf(stderr, "Could not open \"%s\": %m\n", path);
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	if (sb.st_size < sizeof(*hdr)) {
+		close(fd);
+		goto bad;
+	}
+	ix->size = sb.st_size;
+	ix->map = mmap(NULL, ix->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (ix->map == MAP_FAILED) {
+		fprintf(stderr, "dumpet: Could not map \"%s\": %m\n", path);
+		ix->map = NULL;
+		return -1;
+	}
+
+	hdr = (const struct index_header *)ix->map;
+	if (memcmp(hdr->magic, INDEX_MAGIC, sizeof(hdr->magic)))
+		goto bad;
+	if (iso731_to_cpu32(hdr->version) != INDEX_VERSION) {
+		fprintf(stderr, "dumpet: \"%s\" is index version %u; this "
+			"dumpet reads version %u\n", path,
+			iso731_to_cpu32(hdr->version), INDEX_VERSION);
+		return -1;
+	}
+	if (le64_to_cpu(hdr->size) != ix->size)
+		goto bad;
+	ix->nimages = iso731_to_cpu32(hdr->nimages);
+	ix->nentries = iso731_to_cpu32(hdr->nentries);
+
+	lengths[IndexImages] = (uint64_t)ix->nimages * sizeof(*ix->images);
+	lengths[IndexStrings] = ix->nimages ? 1 : 0;
+	lengths[IndexPlatform] = ix->nentries;
+	lengths[IndexMedia] = ix->nentries;
+	lengths[IndexBootable] = ix->nentries;
+	lengths[IndexLBA] = (uint64_t)ix->nentries * sizeof(*ix->lba);
+	lengths[IndexSectors] = (uint64_t)ix->nentries * sizeof(*ix->sectors);
+	lengths[IndexImage] = (uint64_t)ix->nentries * sizeof(*ix->image);
+	lengths[IndexDigest] = (uint64_t)ix->nentries * sizeof(*ix->digest);
+	lengths[IndexByLBA] = (uint64_t)ix->nentries * sizeof(*ix->by_lba);
+	lengths[IndexByDigest] = lengths[IndexByLBA];
+
+	/* sections are in order, so each ends where the next begins */
+	for (s = 0; s < IndexNumSections; s++)
+		offsets[s] = le64_to_cpu(hdr->offsets[s]);
+	offsets[IndexNumSections] = ix->size;
+	for (s = 0; s < IndexNumSections; s++)
+		if (offsets[s] % 8 || offsets[s] < sizeof(*hdr) ||
+				offsets[s] > offsets[s + 1] ||
+				offsets[s + 1] - offsets[s] < lengths[s])
+			goto bad;
+
+	ix->images = (const void *)(ix->map + offsets[IndexImages]);
+	ix->strings = (const char *)(ix->map + offsets[IndexStrings]);
+	ix->strings_size = offsets[IndexStrings + 1] - offsets[IndexStrings];
+	ix->platform = ix->map + offsets[IndexPlatform];
+	ix->media = ix->map + offsets[IndexMedia];
+	ix->bootable = ix->map + offsets[IndexBootable];
+	ix->lba = (const void *)(ix->map + offsets[IndexLBA]);
+	ix->sectors = (const void *)(ix->map + offsets[IndexSectors]);
+	ix->image = (const void *)(ix->map + offsets[IndexImage]);
+	ix->digest = (const void *)(ix->map + offsets[IndexDigest]);
+	ix->by_lba = (const void *)(ix->map + offsets[IndexByLBA]);
+	ix->by_digest = (const void *)(ix->map + offsets[IndexByDigest]);
+	if (ix->strings_size && ix->strings[ix->strings_size - 1] != '\0')
+		goto bad;
+	return 0;
+bad:
+	fprintf(stderr, "dumpet: \"%s\" is not a dumpet index\n", path);
+	return -1;
+}
+
+static void unmap_index(struct index *ix)
+{
+	if (ix->map)
+		munmap((void *)ix->map, ix->size);
+}
+
+/* One "<field>=<value>" of a query; the field is named by its column. */
+struct index_term {
+	IndexSection column;
+	uint32_t value;
+	uint8_t digest[SHA256_DIGEST_SIZE];
+	size_t digest_len;	/* a prefix of the digest may be given */
+};
+
+struct index_name {
+	const char *name;
+	uint32_t value;
+};
+
+static const struct index_name platform_names[] = {
+	{ "80x86", x86 },
+	{ "x86", x86 },
+	{ "ppc", ppc },
+	{ "mac", m68kmac },
+	{ "efi", efi },
+	{ NULL, 0 }
+};
+
+static const struct index_name media_names[] = {
+	{ "no-emulation", NoEmulation },
+	{ "1.2m", OneTwoDiskette },
+	{ "1.44m", OneFourFourDiskette },
+	{ "2.88m", TwoEightEightDiskette },
+	{ "hard-disk", HardDisk },
+	{ NULL, 0 }
+};
+
+static const struct index_name bootable_names[] = {
+	{ "no", 0 },
+	{ "false", 0 },
+	{ "yes", 1 },
+	{ "true", 1 },
+	{ NULL, 0 }
+};
+
+static int parse_number(const char *value, const struct index_name *names,
+			uint32_t max, uint32_t *out)
+{
+	unsigned long long val;
+	char *end;
+	int i;
+
+	for (i = 0; names && names[i].name; i++) {
+		if (!strcasecmp(value, names[i].name)) {
+			*out = names[i].value;
+			return 0;
+		}
+	}
+	errno = 0;
+	val = strtoull(value, &end, 0);
+	if (errno || end == value || *end != '\0' || val > max)
+		return -1;
+	*out = val;
+	return 0;
+}
+
+static int parse_digest(const char *value, struct index_term *term)
+{
+	size_t len = strlen(value);
+	size_t i;
+
+	if (len == 0 || len % 2 || len > 2 * SHA256_DIGEST_SIZE)
+		return -1;
+	for (i = 0; i < len / 2; i++) {
+		unsigned int byte;
+
+		if (!isxdigit(value[2 * i]) || !isxdigit(value[2 * i + 1]) ||
+				sscanf(value + 2 * i, "%2x", &byte) != 1)
+			return -1;
+		term->digest[i] = byte;
+	}
+	term->digest_len = len / 2;
+	return 0;
+}
+
+static int parse_term(const char *spec, struct index_term *term)
+{
+	const char *value = strchr(spec, '=');
+	size_t len;
+
+	memset(term, '\0', sizeof(*term));
+	if (!value)
+		return -1;
+	len = value++ - spec;
+
+#define is_field(name) (len == strlen(name) && !strncmp(spec, name, len))
+	if (is_field("platform")) {
+		term->column = IndexPlatform;
+		return parse_number(value, platform_names, UINT8_MAX,
+				    &term->value);
+	} else if (is_field("media")) {
+		term->column = IndexMedia;
+		return parse_number(value, media_names, UINT8_MAX,
+				    &term->value);
+	} else if (is_field("bootable")) {
+		term->column = IndexBootable;
+		return parse_number(value, bootable_names, 1, &term->value);
+	} else if (is_field("lba")) {
+		term->column = IndexLBA;
+		return parse_number(value, NULL, UINT32_MAX, &term->value);
+	} else if (is_field("sectors")) {
+		term->column = IndexSectors;
+		return parse_number(value, NULL, UINT16_MAX, &term->value);
+	} else if (is_field("digest")) {
+		term->column = IndexDigest;
+		return parse_digest(value, term);
+	}
+#undef is_field
+	return -1;
+}
+
+/* Where entry e stands relative to the term, for the sorted columns. */
+static int compare_term(struct index *ix, struct index_term *term, uint32_t e)
+{
+	uint32_t lba;
+
+	if (term->column == IndexDigest)
+		return memcmp(ix->digest[e], term->digest, term->digest_len);
+	lba = iso731_to_cpu32(ix->lba[e]);
+	return lba < term->value ? -1 : lba > term->value;
+}
+
+static int term_matches(struct index *ix, struct index_term *term, uint32_t e)
+{
+	switch (term->column) {
+		case IndexPlatform:
+			return ix->platform[e] == term->value;
+		case IndexMedia:
+			return ix->media[e] == term->value;
+		case IndexBootable:
+			return ix->bootable[e] == term->value;
+		case IndexSectors:
+			return iso721_to_cpu16(ix->sectors[e]) == term->value;
+		case IndexLBA:
+		case IndexDigest:
+			return compare_term(ix, term, e) == 0;
+		default:
+			return 0;
+	}
+}
+
+/* The run of the sorted order whose entries equal the term. */
+static void find_range(struct index *ix, const uint32_t *order,
+		       struct index_term *term, uint32_t *first,
+		       uint32_t *last)
+{
+	uint32_t lo = 0, hi = ix->nentries;
+
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+
+		if (compare_term(ix, term, iso731_to_cpu32(order[mid])) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*first = lo;
+	for (hi = ix->nentries; lo < hi; ) {
+		uint32_t mid = lo + (hi - lo) / 2;
+
+		if (compare_term(ix, term, iso731_to_cpu32(order[mid])) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*last = lo;
+}
+
+int query_index(const char *path, char **specs, int nspecs)
+{
+	struct index ix;
+	struct index_term *terms;
+	const uint32_t *order = NULL;
+	uint32_t first = 0, last, i, e, image;
+	uint8_t *matched;
+	int found = 0;
+	int t, key = -1;
+
+	terms = calloc(nspecs ? nspecs : 1, sizeof(*terms));
+	if (!terms) {
+		fprintf(stderr, "dumpet: %m\n");
+		return 3;
+	}
+	for (t = 0; t < nspecs; t++) {
+		if (parse_term(specs[t], &terms[t]) < 0) {
+			fprintf(stderr, "dumpet: bad query term \"%s\"\n",
+				specs[t]);
+			free(terms);
+			return 2;
+		}
+		/* a digest narrows things down furthest, then an LBA */
+		if (terms[t].column == IndexDigest ||
+				(terms[t].column == IndexLBA &&
+				 (key < 0 || terms[key].column != IndexDigest)))
+			key = t;
+	}
+
+	if (map_index(&ix, path) < 0) {
+		unmap_index(&ix);
+		free(terms);
+		return 3;
+	}
+	matched = calloc(ix.nimages ? ix.nimages : 1, 1);
+	if (!matched) {
+		fprintf(stderr, "dumpet: %m\n");
+		unmap_index(&ix);
+		free(terms);
+		return 3;
+	}
+
+	last = ix.nentries;
+	if (key >= 0) {
+		order = terms[key].column == IndexDigest ? ix.by_digest
+							 : ix.by_lba;
+		find_range(&ix, order, &terms[key], &first, &last);
+	}
+	for (i = first; i < last; i++) {
+		e = order ? iso731_to_cpu32(order[i]) : i;
+		if (e >= ix.nentries)
+			continue;
+		for (t = 0; t < nspecs; t++)
+			if (!term_matches(&ix, &terms[t], e))
+				break;
+		if (t < nspecs)
+			continue;
+		image = iso731_to_cpu32(ix.image[e]);
+		if (image < ix.nimages)
+			matched[image] = 1;
+	}
+
+	/* in the order the images were indexed */
+	for (image = 0; image < ix.nimages; image++) {
+		uint32_t name = iso731_to_cpu32(ix.images[image].path);
+
+		if (!matched[image] || name >= ix.strings_size)
+			continue;
+		printf("%s\n", ix.strings + name);
+		found = 1;
+	}
+
+	free(matched);
+	unmap_index(&ix);
+	free(terms);
+	return found ? 0 : 1;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
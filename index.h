@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef INDEX_H
+#define INDEX_H
+
+#include <stdint.h>
+
+#include "sha256.h"
+
+/* A corpus index: the boot catalog entries of many images, as columns
+ * that --index-query can search through mmap() without opening any of
+ * the images again.  Everything is little endian, and every section
+ * starts on an 8-byte boundary at the offset the header gives.  The
+ * version goes up whenever the layout changes; readers refuse versions
+ * they don't know. */
+
+#define INDEX_MAGIC "DUMPETIX"
+#define INDEX_VERSION 1
+
+typedef enum {
+	IndexImages,		/* struct index_image[nimages] */
+	IndexStrings,		/* the images' paths, NUL terminated */
+	IndexPlatform,		/* uint8_t[nentries], the header's PlatformId */
+	IndexMedia,		/* uint8_t[nentries], BootMediaType */
+	IndexBootable,		/* uint8_t[nentries], 1 if bootable */
+	IndexLBA,		/* uint32_t[nentries], LoadLBA */
+	IndexSectors,		/* uint16_t[nentries], SectorCount */
+	IndexImage,		/* uint32_t[nentries], which image */
+	IndexDigest,		/* uint8_t[nentries][32], as --store has it */
+	IndexByLBA,		/* uint32_t[nentries], entries sorted by LBA */
+	IndexByDigest,		/* uint32_t[nentries], sorted by digest */
+	IndexNumSections
+} IndexSection;
+
+struct index_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t nimages;
+	uint32_t nentries;
+	uint32_t reserved;
+	uint64_t size;		/* of the whole file, to catch truncation */
+	uint64_t offsets[IndexNumSections];
+};
+
+struct index_image {
+	uint32_t path;		/* offset into the strings */
+	uint32_t first_entry;
+	uint32_t nentries;
+	uint32_t catalog_lba;
+};
+
+/* Write an index of the given images to path, or of the images named on
+ * standard input, one per line, if none are given; images without a boot
+ * catalog are left out with a warning.  Returns 0, or 3 if the index
+ * could not be written. */
+extern int build_index(const char *path, char **images, int nimages);
+
+/* Print the path of each indexed image with an entry matching all of
+ * the "<field>=<value>" terms.  Returns 0 if there were any, 1 if there
+ * were none, 2 for a bad term and 3 for an unusable index. */
+extern int query_index(const char *path, char **terms, int nterms);
+
+#endif /* INDEX_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
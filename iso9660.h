@@ -19,6 +19,9 @@
 #ifndef ISO9660_H
 #define ISO9660_H
 
+#include <stdint.h>
+#include <string.h>
+
 #include "endian.h"
 
 typedef char Sector[0x800];
@@ -47,6 +50,110 @@ typedef char Sector[0x800];
 #define cpu32_to_iso733(x) ((uint64_t)(cpu_to_be32(x) | ( ((uint64_t)cpu_to_le32(x)) << 32)))
 #define iso733_to_cpu32(x) be32_to_cpu((uint32_t)((x) & 0xffffffff))
 
+/* Fields recorded in both byte orders are declared as [2], little endian
+ * first; we only ever read the little endian half, and write both. */
+static inline uint32_t get_iso733(const void *both)
+{
+	uint32_t le;
+	memcpy(&le, both, sizeof(le));
+	return iso731_to_cpu32(le);
+}
+
+static inline void set_iso733(void *both, uint32_t value)
+{
+	uint32_t le = cpu32_to_iso731(value);
+	uint32_t be = cpu32_to_iso732(value);
+	memcpy(both, &le, sizeof(le));
+	memcpy((char *)both + sizeof(le), &be, sizeof(be));
+}
+
+static inline uint16_t get_iso723(const void *both)
+{
+	uint16_t le;
+	memcpy(&le, both, sizeof(le));
+	return iso721_to_cpu16(le);
+}
+
+/* ECMA-119 9.1 */
+#define DIRECTORY_RECORD_HIDDEN		0x01
+#define DIRECTORY_RECORD_DIRECTORY	0x02
+#define DIRECTORY_RECORD_MULTI_EXTENT	0x80
+
+typedef struct {
+	uint8_t Length;
+	uint8_t ExtendedAttributeLength;
+	uint32_t ExtentLocation[2];
+	uint32_t DataLength[2];
+	uint8_t RecordingTime[7];
+	uint8_t FileFlags;
+	uint8_t FileUnitSize;
+	uint8_t InterleaveGapSize;
+	uint16_t VolumeSequenceNumber[2];
+	uint8_t FileIdentifierLength;
+	char FileIdentifier[];
+} __attribute__((packed)) DirectoryRecord;
+
+/* ECMA-119 8.1 */
+typedef enum {
+	BootRecordDescriptor = 0,
+	PrimaryDescriptor = 1,
+	SupplementaryDescriptor = 2,
+	PartitionDescriptor = 3,
+	TerminatorDescriptor = 255
+} VolumeDescriptorType;
+
+/* ECMA-119 8.4 */
+typedef union {
+	Sector Raw;
+	struct {
+		uint8_t Type;
+		char Iso9660[5];
+		uint8_t Version;
+		uint8_t Reserved0;
+		char SystemId[32];
+		char VolumeId[32];
+		uint8_t Reserved1[8];
+		uint32_t VolumeSpaceSize[2];
+		uint8_t EscapeSequences[32];	/* supplementary only */
+		uint16_t VolumeSetSize[2];
+		uint16_t VolumeSequenceNumber[2];
+		uint16_t LogicalBlockSize[2];
+		uint32_t PathTableSize[2];
+		uint32_t LPathTable;
+		uint32_t OptionalLPathTable;
+		uint32_t MPathTable;
+		uint32_t OptionalMPathTable;
+		uint8_t RootDirectoryRecord[34];
+		char VolumeSetId[128];
+		char PublisherId[128];
+		char PreparerId[128];
+		char ApplicationId[128];
+		char CopyrightFileId[37];
+		char AbstractFileId[37];
+		char BibliographicFileId[37];
+		char CreationDate[17];
+		char ModificationDate[17];
+		char ExpirationDate[17];
+		char EffectiveDate[17];
+		uint8_t FileStructureVersion;
+	} __attribute__((packed));
+} PrimaryVolumeDescriptor;
+
+/* ECMA-119 8.6 */
+typedef union {
+	Sector Raw;
+	struct {
+		uint8_t Type;
+		char Iso9660[5];
+		uint8_t Version;
+		uint8_t Reserved0;
+		char SystemId[32];
+		char PartitionId[32];
+		uint32_t PartitionLocation[2];
+		uint32_t PartitionSize[2];
+	} __attribute__((packed));
+} VolumePartitionDescriptor;
+
 #if 0
 static void test_iso_functions(void)
 {
@@ -0,0 +1,336 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include "dumpet.h"
+#include "catalog.h"
+#include "lint.h"
+#include "volume.h"
+
+struct lint {
+	struct context *context;
+	int errors;
+	int warnings;
+};
+
+static void __attribute__((format(printf, 3, 4)))
+report(struct lint *lint, int error, const char *fmt, ...)
+{
+	va_list ap;
+
+	if (error)
+		lint->errors++;
+	else
+		lint->warnings++;
+	printf("%s: %s: ", lint->context->filename,
+	       error ? "error" : "warning");
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+	printf("\n");
+}
+
+/* Header indicator sequencing, on the raw sector: validation entry,
+ * default entry, then section headers each followed by their entries
+ * (and any extension entries), the last header marked final. */
+static void lint_sequence(struct lint *lint, BootCatalog *raw)
+{
+	int final = -1, last = -1;
+	int next = 2;
+
+	while (next < MAX_CATALOG_ENTRIES) {
+		BootCatalogSectionHeaderEntry *sh =
+			&raw->Catalog[next].SectionHeaderEntry;
+		uint16_t count;
+		int i;
+
+		if (sh->HeaderIndicator != SectionHeaderIndicator &&
+				sh->HeaderIndicator !=
+					FinalSectionHeaderIndicator) {
+			if (sh->HeaderIndicator != 0)
+				report(lint, 0, "unexpected header indicator "
+				       "0x%02x at catalog entry %d",
+				       sh->HeaderIndicator, next);
+			break;
+		}
+		if (final >= 0)
+			report(lint, 1, "section header at catalog entry %d "
+			       "follows the final section header at entry %d",
+			       next, final);
+		last = next;
+		if (sh->HeaderIndicator == FinalSectionHeaderIndicator &&
+				final < 0)
+			final = next;
+
+		memcpy(&count, &sh->SectionEntryCount, sizeof(count));
+		count = iso721_to_cpu16(count);
+		if (count == 0)
+			report(lint, 0, "section header at catalog entry %d "
+			       "has no entries", next);
+		next++;
+		for (i = 0; i < count; i++) {
+			if (next >= MAX_CATALOG_ENTRIES) {
+				report(lint, 1, "section at catalog entry %d "
+				       "runs past the end of the catalog "
+				       "sector", last);
+				return;
+			}
+			next++;
+			while (next < MAX_CATALOG_ENTRIES &&
+					raw->Catalog[next].Raw[0] ==
+						ExtensionIndicator)
+				next++;
+		}
+	}
+	if (last >= 0 && final < 0)
+		report(lint, 1, "last section header (catalog entry %d) is not "
+		       "marked final", last);
+}
+
+struct interval {
+	uint32_t start;
+	uint32_t end;		/* exclusive */
+	int entry;		/* -1 for the catalog itself */
+};
+
+static int interval_cmp(const void *a, const void *b)
+{
+	const struct interval *x = a, *y = b;
+
+	if (x->start != y->start)
+		return x->start < y->start ? -1 : 1;
+	if (x->end != y->end)
+		return x->end < y->end ? -1 : 1;
+	return x->entry - y->entry;
+}
+
+static void describe(char *buf, size_t n, struct interval *iv)
+{
+	if (iv->entry < 0)
+		snprintf(buf, n, "the boot catalog (sector %u)", iv->start);
+	else
+		snprintf(buf, n, "entry %d (sectors %u-%u)", iv->entry,
+			 iv->start, iv->end - 1);
+}
+
+/* Sort by start and sweep, remembering the interval that reaches
+ * furthest; anything starting before that end overlaps it.  Entries that
+ * describe exactly the same image (a default entry repeated in a section,
+ * say) are fine. */
+static void lint_overlaps(struct lint *lint, struct interval *iv, int n)
+{
+	char a[64], b[64];
+	int reach = -1;
+	int i;
+
+	qsort(iv, n, sizeof(*iv), interval_cmp);
+	for (i = 0; i < n; i++) {
+		if (reach >= 0 && iv[i].start < iv[reach].end) {
+			int same = iv[i].entry >= 0 && iv[reach].entry >= 0 &&
+				   iv[i].start == iv[reach].start &&
+				   iv[i].end == iv[reach].end;
+
+			if (!same) {
+				describe(a, sizeof(a), &iv[reach]);
+				describe(b, sizeof(b), &iv[i]);
+				report(lint, 1, "%s overlaps %s", b, a);
+			}
+		}
+		if (reach < 0 || iv[i].end > iv[reach].end)
+			reach = i;
+	}
+}
+
+static void lint_entries(struct lint *lint, struct boot_catalog *cat,
+			 struct iso_volume *vol, uint64_t file_sectors)
+{
+	struct interval iv[MAX_CATALOG_ENTRIES + 1];
+	int n = 0;
+	int i;
+
+	iv[n].start = cat->lba;
+	iv[n].end = cat->lba + 1;
+	iv[n++].entry = -1;
+
+	for (i = 0; i < cat->nentries; i++) {
+		struct boot_entry *entry = &cat->entries[i];
+		uint64_t end = (uint64_t)entry->LoadLBA +
+			       boot_entry_sectors(entry);
+
+		if (entry->BootIndicator != Bootable &&
+				entry->BootIndicator != NotBootable)
+			report(lint, 1, "entry %d has invalid boot indicator "
+			       "0x%02x", i, entry->BootIndicator);
+		if (entry->BootMediaType > HardDisk)
+			report(lint, 1, "entry %d has invalid boot media type "
+			       "0x%02x", i, entry->BootMediaType);
+		if (entry->LoadLBA == 0) {
+			report(lint, 1, "entry %d has no load LBA", i);
+			continue;
+		}
+		if (end == entry->LoadLBA) {
+			report(lint, 0, "entry %d has a sector count of 0, so "
+			       "it loads nothing", i);
+			continue;
+		}
+		if (vol->has_pvd && end > vol->VolumeSpaceSize)
+			report(lint, 1, "entry %d (sectors %u-%"PRIu64") ends "
+			       "past the volume space size (%u sectors)", i,
+			       entry->LoadLBA, end - 1, vol->VolumeSpaceSize);
+		if (end > file_sectors)
+			report(lint, 1, "entry %d (sectors %u-%"PRIu64") ends "
+			       "past the end of the file (%"PRIu64" sectors)",
+			       i, entry->LoadLBA, end - 1, file_sectors);
+		if (end > UINT32_MAX)
+			continue;
+
+		iv[n].start = entry->LoadLBA;
+		iv[n].end = end;
+		iv[n++].entry = i;
+	}
+	lint_overlaps(lint, iv, n);
+}
+
+int lint_image(struct context *context)
+{
+	struct lint lint = { .context = context };
+	struct descriptor_set *set;
+	struct boot_catalog *cat;
+	BootCatalogValidationEntry *ve;
+	uint64_t file_sectors;
+	struct stat sb;
+
+	set = malloc(sizeof(*set));
+	cat = malloc(sizeof(*cat));
+	if (!set || !cat) {
+		fprintf(stderr, "dumpet: %m\n");
+		free(set);
+		free(cat);
+		return 3;
+	}
+
+	if (fstat(fileno(context->iso), &sb) < 0) {
+		fprintf(stderr, "dumpet: could not stat \"%s\": %m\n",
+			context->filename);
+		free(set);
+		free(cat);
+		return 3;
+	}
+	if (S_ISREG(sb.st_mode)) {
+		file_sectors = sb.st_size / sizeof(Sector);
+		if (sb.st_size % sizeof(Sector))
+			report(&lint, 0, "file size %lld is not a multiple of "
+			       "%zd", (long long)sb.st_size, sizeof(Sector));
+	} else {
+		off_t end = lseek(fileno(context->iso), 0, SEEK_END);
+
+		file_sectors = end < 0 ? UINT64_MAX : end / sizeof(Sector);
+	}
+
+	stats_phase_begin(PhaseBootRecord);
+	if (read_descriptor_set(context->iso, set) < 0) {
+		stats_phase_end(PhaseBootRecord);
+		free(set);
+		free(cat);
+		return 3;
+	}
+	stats_phase_end(PhaseBootRecord);
+
+	/* a stream's length is only known at its end; all lint needs from
+	 * the rest of it is the catalog */
+	if (input_stream) {
+		if (set->boot_record >= 0)
+			stream_want(input_stream, set->BootCatalogLBA, 1);
+		if (stream_finish(input_stream) < 0) {
+			fprintf(stderr, "dumpet: Error reading image: %s\n",
+				strerror(input_stream->error));
+			free(set);
+			free(cat);
+			return 3;
+		}
+		file_sectors = input_stream->bytes / sizeof(Sector);
+		if (input_stream->bytes % sizeof(Sector))
+			report(&lint, 0, "file size %"PRIu64" is not a "
+			       "multiple of %zd", input_stream->bytes,
+			       sizeof(Sector));
+	}
+
+	if (!set->primary.has_pvd)
+		report(&lint, 1, "no primary volume descriptor");
+	else if (set->primary.VolumeSpaceSize > file_sectors)
+		report(&lint, 1, "image is truncated: the volume is %u sectors "
+		       "but the file is %"PRIu64, set->primary.VolumeSpaceSize,
+		       file_sectors);
+	if (!set->terminated)
+		report(&lint, 1, "no volume descriptor set terminator");
+	if (set->boot_record < 0) {
+		report(&lint, 1, "no El Torito boot record");
+		goto out;
+	}
+	if (set->BootCatalogLBA >= file_sectors) {
+		report(&lint, 1, "boot catalog (sector %u) is past the end of "
+		       "the file", set->BootCatalogLBA);
+		goto out;
+	}
+
+	stats_phase_begin(PhaseCatalog);
+	if (read_boot_catalog(context->iso, set->BootCatalogLBA, cat) < 0) {
+		stats_phase_end(PhaseCatalog);
+		free(set);
+		free(cat);
+		return 3;
+	}
+	stats_phase_end(PhaseCatalog);
+
+	ve = &cat->raw.Catalog[0].ValidationEntry;
+	if (ve->HeaderIndicator != ValidationIndicator)
+		report(&lint, 1, "boot catalog (sector %u) does not start with "
+		       "a validation entry (header indicator 0x%02x)",
+		       cat->lba, ve->HeaderIndicator);
+	if (ve->FiveFive != 0x55 || ve->AA != 0xaa)
+		report(&lint, 1, "validation entry key bytes are 0x%02x%02x, "
+		       "not 0x55aa", ve->FiveFive, ve->AA);
+	if (!cat->checksum_ok) {
+		report(&lint, 1, "validation entry checksum is incorrect");
+		/* check the rest as if it were right */
+		fixValidationEntry(ve);
+		parse_boot_catalog(cat);
+	}
+
+	lint_sequence(&lint, &cat->raw);
+	lint_entries(&lint, cat, &set->primary, file_sectors);
+
+out:
+	if (lint.errors || lint.warnings)
+		printf("%s: %d error%s, %d warning%s\n", context->filename,
+		       lint.errors, lint.errors == 1 ? "" : "s",
+		       lint.warnings, lint.warnings == 1 ? "" : "s");
+	free(set);
+	free(cat);
+	return lint.errors ? 1 : 0;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
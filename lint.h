@@ -0,0 +1,27 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LINT_H
+#define LINT_H
+
+#include "dumpet.h"
+
+/* Check the structure of the image using only the volume descriptors and
+ * the boot catalog; returns 0 if nothing is wrong, 1 if something is. */
+extern int lint_image(struct context *context);
+
+#endif /* LINT_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MD5_H
+#define MD5_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* RFC 1321 MD5, fed incrementally; only for checking digests other tools
+ * have already put on the media. */
+
+#define MD5_DIGEST_SIZE 16
+
+struct md5_ctx {
+	uint32_t h[4];
+	uint64_t length;	/* bytes hashed so far */
+	size_t nbuf;
+	uint8_t buf[64];
+};
+
+extern void md5_init(struct md5_ctx *ctx);
+extern void md5_update(struct md5_ctx *ctx, const void *data, size_t len);
+extern void md5_final(struct md5_ctx *ctx, uint8_t digest[MD5_DIGEST_SIZE]);
+
+#endif /* MD5_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
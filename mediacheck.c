@@ -0,0 +1,378 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <fcntl.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "dumpet.h"
+#include "mediacheck.h"
+#include "md5.h"
+#include "volume.h"
+
+/* isomd5sum's layout: the application use field of the PVD holds
+ * "ISO MD5SUM = <hex>;SKIPSECTORS = <n>;RHLISOSTATUS=<0|1>;FRAGMENT SUMS
+ * = <hex>;FRAGMENT COUNT = <n>;", and is taken as all spaces when hashing.
+ * The last SKIPSECTORS sectors of the volume aren't hashed at all. */
+#define APPDATA_OFFSET		883
+#define APPDATA_SIZE		512
+#define FRAGMENT_SUM_SIZE	60
+#define DEFAULT_SKIPSECTORS	15
+
+/* checkisomd5 reads 32K at a time and checks a fragment when a read
+ * starts in a new one, so that is where each fragment sum ends. */
+#define CHECK_STRIDE		32768
+
+/* The reader runs ahead of the hasher by up to MEDIA_BUFFERS reads. */
+#define MEDIA_READ_SIZE		(4 << 20)
+#define MEDIA_BUFFERS		4
+
+struct isomd5sum {
+	char md5[MD5_DIGEST_SIZE * 2 + 1];
+	unsigned long skipsectors;
+	int status;		/* RHLISOSTATUS, or -1 */
+	char fragment_sums[APPDATA_SIZE + 1];
+	unsigned long fragment_count;
+};
+
+struct media_buffer {
+	uint8_t *data;
+	size_t len;
+	int full;
+};
+
+struct media_reader {
+	int fd;
+	uint64_t total;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	struct media_buffer buffers[MEDIA_BUFFERS];
+	int stop;
+	int done;		/* the reader has nothing more to give */
+	int error;		/* -errno, or 0 */
+};
+
+static const char *appdata_field(const char *appdata, const char *name)
+{
+	const char *p = strstr(appdata, name);
+
+	return p ? p + strlen(name) : NULL;
+}
+
+static int parse_isomd5sum(const uint8_t *raw, struct isomd5sum *sums)
+{
+	char appdata[APPDATA_SIZE + 1];
+	const char *p;
+	size_t n;
+
+	memcpy(appdata, raw, APPDATA_SIZE);
+	appdata[APPDATA_SIZE] = '\0';
+	memset(sums, '\0', sizeof(*sums));
+
+	p = appdata_field(appdata, "ISO MD5SUM = ");
+	if (!p || strspn(p, "0123456789abcdefABCDEF") < sizeof(sums->md5) - 1)
+		return -ENOENT;
+	memcpy(sums->md5, p, sizeof(sums->md5) - 1);
+
+	p = appdata_field(appdata, "SKIPSECTORS = ");
+	sums->skipsectors = p ? strtoul(p, NULL, 10) : DEFAULT_SKIPSECTORS;
+
+	p = appdata_field(appdata, "RHLISOSTATUS=");
+	sums->status = p ? *p == '1' : -1;
+
+	p = appdata_field(appdata, "FRAGMENT SUMS = ");
+	if (p) {
+		n = strcspn(p, ";");
+		memcpy(sums->fragment_sums, p, n);
+	}
+	p = appdata_field(appdata, "FRAGMENT COUNT = ");
+	if (p && sums->fragment_sums[0])
+		sums->fragment_count = strtoul(p, NULL, 10);
+	return 0;
+}
+
+static void *media_read(void *arg)
+{
+	struct media_reader *r = arg;
+	uint64_t offset;
+	int i = 0;
+
+	for (offset = 0; offset < r->total; i = (i + 1) % MEDIA_BUFFERS) {
+		struct media_buffer *b = &r->buffers[i];
+		size_t want = r->total - offset < MEDIA_READ_SIZE ?
+			      r->total - offset : MEDIA_READ_SIZE;
+		size_t got = 0;
+		int error = 0;
+
+		pthread_mutex_lock(&r->lock);
+		while (b->full && !r->stop)
+			pthread_cond_wait(&r->cond, &r->lock);
+		if (r->stop) {
+			pthread_mutex_unlock(&r->lock);
+			break;
+		}
+		pthread_mutex_unlock(&r->lock);
+
+		while (got < want) {
+			ssize_t n = pread(r->fd, b->data + got, want - got,
+					  offset + got);
+
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0) {
+				error = n < 0 ? -errno : -ENODATA;
+				break;
+			}
+			got += n;
+		}
+		iostats.reads++;
+		iostats.bytes_read += got;
+		dumpet_probe3(read_sector, offset / sizeof(Sector),
+			      want / sizeof(Sector), error);
+
+		pthread_mutex_lock(&r->lock);
+		b->len = got;
+		b->full = 1;
+		if (error)
+			r->error = error;
+		pthread_cond_broadcast(&r->cond);
+		pthread_mutex_unlock(&r->lock);
+		if (error)
+			break;
+		offset += got;
+	}
+	pthread_mutex_lock(&r->lock);
+	r->done = 1;
+	pthread_cond_broadcast(&r->cond);
+	pthread_mutex_unlock(&r->lock);
+	return NULL;
+}
+
+/* The first hex digit of each of a prefix digest's first bytes, which is
+ * what implantisomd5 records for a fragment ("%01x" into a 2-byte buffer,
+ * so 0x0a gives 'a' and 0xab gives 'a' too). */
+static int fragment_ok(struct md5_ctx *ctx, struct isomd5sum *sums,
+		       uint64_t fragment)
+{
+	size_t per = FRAGMENT_SUM_SIZE / sums->fragment_count;
+	size_t j = (fragment - 1) * per;
+	uint8_t digest[MD5_DIGEST_SIZE];
+	struct md5_ctx copy = *ctx;
+	size_t i;
+
+	md5_final(&copy, digest);
+	for (i = 0; i < per && i < MD5_DIGEST_SIZE; i++, j++) {
+		char hex[3];
+
+		snprintf(hex, sizeof(hex), "%01x", digest[i]);
+		if (j >= sizeof(sums->fragment_sums) ||
+				hex[0] != sums->fragment_sums[j])
+			return 0;
+	}
+	return 1;
+}
+
+static void hex_digest(const uint8_t *digest, char *hex)
+{
+	int i;
+
+	for (i = 0; i < MD5_DIGEST_SIZE; i++)
+		sprintf(hex + i * 2, "%02x", digest[i]);
+}
+
+/* The fragment sums are digests of ever longer prefixes of the image, so
+ * they're all points along one MD5 computation and can't be split across
+ * threads.  What can run alongside it is the reading: a second thread
+ * keeps a few large reads in flight so the hasher never waits on the
+ * disk, and the first bad fragment stops both. */
+int check_media(struct context *context)
+{
+	struct descriptor_set *set;
+	struct media_reader r;
+	struct isomd5sum sums;
+	struct md5_ctx ctx;
+	pthread_t reader;
+	Sector pvd;
+	uint8_t digest[MD5_DIGEST_SIZE];
+	char hex[MD5_DIGEST_SIZE * 2 + 1];
+	uint64_t appdata, fragment_size = 0, offset = 0, prev = 0;
+	uint32_t pvd_lba = 0;
+	int i, rc = 0, bad_fragment = 0, started;
+
+	set = calloc(1, sizeof(*set));
+	if (!set) {
+		fprintf(stderr, "dumpet: %m\n");
+		return 3;
+	}
+	stats_phase_begin(PhaseBootRecord);
+	if (read_descriptor_set(context->iso, set) < 0) {
+		stats_phase_end(PhaseBootRecord);
+		free(set);
+		return 3;
+	}
+	for (i = 0; i < set->ndescriptors; i++) {
+		if (!strcmp(set->descriptors[i].Id, "CD001") &&
+				set->descriptors[i].Type == PrimaryDescriptor) {
+			pvd_lba = set->descriptors[i].lba;
+			break;
+		}
+	}
+	if (!set->primary.has_pvd || read_sector(context->iso, pvd_lba,
+						 &pvd) < 0) {
+		stats_phase_end(PhaseBootRecord);
+		if (!set->primary.has_pvd)
+			fprintf(stderr, "dumpet: no primary volume descriptor "
+				"in \"%s\"\n", context->filename);
+		free(set);
+		return 3;
+	}
+	stats_phase_end(PhaseBootRecord);
+
+	if (parse_isomd5sum((uint8_t *)pvd + APPDATA_OFFSET, &sums) < 0) {
+		fprintf(stderr, "dumpet: no isomd5sum data in \"%s\"\n",
+			context->filename);
+		free(set);
+		return 5;
+	}
+
+	memset(&r, '\0', sizeof(r));
+	r.fd = fileno(context->iso);
+	r.total = (uint64_t)set->primary.VolumeSpaceSize * sizeof(Sector);
+	r.total -= sums.skipsectors * sizeof(Sector) < r.total ?
+		   sums.skipsectors * sizeof(Sector) : r.total;
+	appdata = (uint64_t)pvd_lba * sizeof(Sector) + APPDATA_OFFSET;
+	free(set);
+	if (sums.fragment_count)
+		fragment_size = r.total / (sums.fragment_count + 1);
+
+	printf("Media MD5: %s\n", sums.md5);
+	printf("\tHashed: %"PRIu64" bytes (%lu sectors at the end skipped)\n",
+	       r.total, sums.skipsectors);
+	printf("\tFragments: %lu\n", sums.fragment_count);
+	if (sums.status >= 0)
+		printf("\tMedia check status: %s\n",
+		       sums.status ? "supported" : "not supported");
+
+	for (i = 0; i < MEDIA_BUFFERS; i++) {
+		if (posix_memalign((void **)&r.buffers[i].data, 4096,
+				   MEDIA_READ_SIZE)) {
+			fprintf(stderr, "dumpet: %m\n");
+			while (i--)
+				free(r.buffers[i].data);
+			return 3;
+		}
+	}
+	pthread_mutex_init(&r.lock, NULL);
+	pthread_cond_init(&r.cond, NULL);
+
+	stats_phase_begin(PhaseMediaCheck);
+	posix_fadvise(r.fd, 0, r.total, POSIX_FADV_SEQUENTIAL);
+	md5_init(&ctx);
+	started = pthread_create(&reader, NULL, media_read, &r) == 0;
+	if (!started) {
+		fprintf(stderr, "dumpet: could not start reader: %m\n");
+		rc = 3;
+	}
+
+	for (i = 0; started && offset < r.total && !bad_fragment;
+	     i = (i + 1) % MEDIA_BUFFERS) {
+		struct media_buffer *b = &r.buffers[i];
+		size_t pos, n;
+
+		pthread_mutex_lock(&r.lock);
+		while (!b->full && !r.done)
+			pthread_cond_wait(&r.cond, &r.lock);
+		pthread_mutex_unlock(&r.lock);
+		if (!b->full || b->len == 0)
+			break;
+
+		if (appdata < offset + b->len && appdata + APPDATA_SIZE > offset) {
+			uint64_t from = appdata > offset ? appdata - offset : 0;
+			uint64_t to = appdata + APPDATA_SIZE - offset;
+
+			if (to > b->len)
+				to = b->len;
+			memset(b->data + from, ' ', to - from);
+		}
+
+		for (pos = 0; pos < b->len; pos += n) {
+			uint64_t fragment;
+
+			n = b->len - pos < CHECK_STRIDE ? b->len - pos
+							: CHECK_STRIDE;
+			md5_update(&ctx, b->data + pos, n);
+			if (!fragment_size)
+				continue;
+			fragment = (offset + pos) / fragment_size;
+			if (fragment == prev)
+				continue;
+			prev = fragment;
+			if (!fragment_ok(&ctx, &sums, fragment)) {
+				printf("\tFragment %"PRIu64" of %lu: FAIL\n",
+				       fragment, sums.fragment_count);
+				bad_fragment = 1;
+				break;
+			}
+		}
+		offset += b->len;
+
+		pthread_mutex_lock(&r.lock);
+		b->full = 0;
+		if (bad_fragment)
+			r.stop = 1;
+		pthread_cond_broadcast(&r.cond);
+		pthread_mutex_unlock(&r.lock);
+	}
+	if (started)
+		pthread_join(reader, NULL);
+	stats_phase_end(PhaseMediaCheck);
+
+	if (r.error == -ENODATA && !bad_fragment) {
+		printf("\tImage is truncated at byte %"PRIu64"\n", offset);
+		rc = 1;
+	} else if (r.error && !bad_fragment) {
+		fprintf(stderr, "dumpet: Error reading image: %s\n",
+			strerror(-r.error));
+		rc = 3;
+	} else if (bad_fragment) {
+		rc = 1;
+	} else if (rc == 0) {
+		md5_final(&ctx, digest);
+		hex_digest(digest, hex);
+		if (sums.fragment_count)
+			printf("\tFragment sums: OK\n");
+		printf("\tComputed MD5: %s\n", hex);
+		rc = strcasecmp(hex, sums.md5) ? 1 : 0;
+	}
+	if (rc != 3)
+		printf("Media check: %s\n", rc ? "FAIL" : "PASS");
+
+	pthread_cond_destroy(&r.cond);
+	pthread_mutex_destroy(&r.lock);
+	for (i = 0; i < MEDIA_BUFFERS; i++)
+		free(r.buffers[i].data);
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,28 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MEDIACHECK_H
+#define MEDIACHECK_H
+
+#include "dumpet.h"
+
+/* Verify the whole-image MD5 and the fragment sums that implantisomd5
+ * leaves in the primary volume descriptor's application use field, with
+ * the same results checkisomd5 would give. */
+extern int check_media(struct context *context);
+
+#endif /* MEDIACHECK_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,530 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "dumpet.h"
+#include "endian.h"
+#include "libapplepart.h"
+#include "partition.h"
+#include "render.h"
+#include "source.h"
+
+#define ESP_GUID "C12A7328-F81F-11D2-BA4B-00A0C93EC93B"
+
+static const struct {
+	const char *name;
+	const char *label;
+} schemes[] = {
+	[SchemeApm] = { "apm", "APM" },
+	[SchemeMbr] = { "mbr", "MBR" },
+	[SchemeGpt] = { "gpt", "GPT" },
+};
+
+static int add_partition(struct partition **parts, int *n,
+			 struct partition *part)
+{
+	struct partition *new = realloc(*parts, (*n + 1) * sizeof(**parts));
+
+	if (!new)
+		return -errno;
+	new[(*n)++] = *part;
+	*parts = new;
+	return 0;
+}
+
+static int read_apm(FILE *iso, struct partition **parts, int *n)
+{
+	AppleDiskLabel *adl;
+	int fd = fileno(iso);
+	int i, rc = 0;
+	uint16_t bs;
+
+	lseek(fd, 0, SEEK_SET);
+	adl = adl_read(fd);
+	if (!adl)
+		return 0;
+	bs = adl_get_block_size(adl);
+
+	/* the accessors count the map's own entry, as Apple numbers them */
+	for (i = 0; rc == 0; i++) {
+		char namebuf[33] = "", typebuf[33] = "";
+		char *name = namebuf, *type = typebuf;
+		struct partition part = { .scheme = SchemeApm, .index = i + 1 };
+		uint32_t start = 0, blocks = 0;
+
+		if (adl_get_partition_type(adl, i, &type) < 0)
+			break;
+		adl_get_partition_name(adl, i, &name);
+		adl_get_partition_pblock_start(adl, i, &start);
+		adl_get_partition_blocks(adl, i, &blocks);
+
+		part.offset = (uint64_t)start * bs;
+		part.size = (uint64_t)blocks * bs;
+		memcpy(part.type, typebuf, sizeof(typebuf));
+		memcpy(part.name, namebuf, sizeof(namebuf));
+		rc = add_partition(parts, n, &part);
+	}
+	adl_free(adl);
+	return rc;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	uint32_t x;
+
+	memcpy(&x, p, sizeof(x));
+	return le32_to_cpu(x);
+}
+
+static uint64_t get_le64(const uint8_t *p)
+{
+	uint64_t x;
+
+	memcpy(&x, p, sizeof(x));
+	return le64_to_cpu(x);
+}
+
+/* only the primary entries; hybrid images don't use logical ones */
+static int read_mbr(struct byte_source *src, struct partition **parts,
+		    int *n)
+{
+	uint8_t mbr[512];
+	int i, rc = 0;
+
+	if (source_read(src, 0, mbr, sizeof(mbr)) != sizeof(mbr) ||
+			mbr[510] != 0x55 || mbr[511] != 0xaa)
+		return 0;
+
+	for (i = 0; i < 4 && rc == 0; i++) {
+		const uint8_t *entry = mbr + 446 + 16 * i;
+		struct partition part = { .scheme = SchemeMbr, .index = i + 1 };
+
+		if (!entry[4] || !get_le32(entry + 12))
+			continue;
+		part.offset = (uint64_t)get_le32(entry + 8) * 512;
+		part.size = (uint64_t)get_le32(entry + 12) * 512;
+		snprintf(part.type, sizeof(part.type), "0x%02x", entry[4]);
+		rc = add_partition(parts, n, &part);
+	}
+	return rc;
+}
+
+static uint32_t crc32(const uint8_t *data, size_t len)
+{
+	uint32_t crc = 0xffffffff;
+	int bit;
+
+	while (len--) {
+		crc ^= *data++;
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+	}
+	return ~crc;
+}
+
+static void format_guid(char *buf, const uint8_t *guid)
+{
+	sprintf(buf, "%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X",
+		get_le32(guid), guid[4] | guid[5] << 8, guid[6] | guid[7] << 8,
+		guid[8], guid[9], guid[10], guid[11], guid[12], guid[13],
+		guid[14], guid[15]);
+}
+
+/* UTF-16LE to UTF-8; names are meant to be in the BMP */
+static void format_name(char *buf, size_t size, const uint8_t *name,
+			int units)
+{
+	size_t len = 0;
+	int i;
+
+	for (i = 0; i < units; i++) {
+		unsigned int c = name[2 * i] | name[2 * i + 1] << 8;
+
+		if (!c)
+			break;
+		if (c >= 0xd800 && c < 0xe000)
+			c = '?';
+		if (c < 0x80 && len + 1 < size) {
+			buf[len++] = c;
+		} else if (c < 0x800 && len + 2 < size) {
+			buf[len++] = 0xc0 | c >> 6;
+			buf[len++] = 0x80 | (c & 0x3f);
+		} else if (c >= 0x800 && len + 3 < size) {
+			buf[len++] = 0xe0 | c >> 12;
+			buf[len++] = 0x80 | ((c >> 6) & 0x3f);
+			buf[len++] = 0x80 | (c & 0x3f);
+		} else {
+			break;
+		}
+	}
+	buf[len] = '\0';
+}
+
+static int read_gpt_entries(struct byte_source *src, const uint8_t *hdr,
+			    uint32_t sector_size, struct partition **parts,
+			    int *n)
+{
+	static const uint8_t unused[16];
+	uint64_t lba = get_le64(hdr + 72);
+	uint32_t count = get_le32(hdr + 80);
+	uint32_t size = get_le32(hdr + 84);
+	uint8_t *entries;
+	ssize_t len;
+	int i, rc = 0;
+
+	if (size < 128 || size % 8 || (uint64_t)count * size > 1 << 20) {
+		fprintf(stderr, "dumpet: the GPT's partition entry array "
+			"doesn't make sense; ignoring it\n");
+		return 0;
+	}
+	entries = malloc((size_t)count * size);
+	if (!entries)
+		return -errno;
+	len = source_read(src, lba * sector_size, entries, count * size);
+	if (len < 0) {
+		free(entries);
+		return len;
+	}
+	if (len != (ssize_t)count * size)
+		fprintf(stderr, "dumpet: the GPT's partition entry array runs "
+			"past the end of the image\n");
+	else if (crc32(entries, len) != get_le32(hdr + 88))
+		fprintf(stderr, "dumpet: the GPT's partition entry array has a "
+			"bad checksum\n");
+
+	for (i = 0; (i + 1) * size <= len && rc == 0; i++) {
+		const uint8_t *entry = entries + i * size;
+		struct partition part = { .scheme = SchemeGpt, .index = i + 1 };
+		uint64_t first = get_le64(entry + 32);
+		uint64_t last = get_le64(entry + 40);
+
+		if (!memcmp(entry, unused, sizeof(unused)) || last < first)
+			continue;
+		part.offset = first * sector_size;
+		part.size = (last - first + 1) * sector_size;
+		format_guid(part.type, entry);
+		format_name(part.name, sizeof(part.name), entry + 56, 36);
+		rc = add_partition(parts, n, &part);
+	}
+	free(entries);
+	return rc;
+}
+
+/* The header is in the second logical block, which is 512 bytes on
+ * everything but 4Kn disks. */
+static int read_gpt(struct byte_source *src, struct partition **parts,
+		    int *n)
+{
+	static const uint32_t sector_sizes[] = { 512, 4096 };
+	int i;
+
+	for (i = 0; i < sizeof(sector_sizes) / sizeof(sector_sizes[0]); i++) {
+		uint8_t hdr[512];
+		uint32_t size, crc;
+
+		if (source_read(src, sector_sizes[i], hdr, sizeof(hdr)) !=
+				sizeof(hdr) || memcmp(hdr, "EFI PART", 8))
+			continue;
+		size = get_le32(hdr + 12);
+		if (size < 92 || size > sizeof(hdr) || get_le64(hdr + 24) != 1)
+			continue;
+		crc = get_le32(hdr + 16);
+		memset(hdr + 16, '\0', 4);
+		if (crc32(hdr, size) != crc) {
+			fprintf(stderr, "dumpet: the GPT header at byte %u has "
+				"a bad checksum; ignoring it\n",
+				sector_sizes[i]);
+			continue;
+		}
+		return read_gpt_entries(src, hdr, sector_sizes[i], parts, n);
+	}
+	return 0;
+}
+
+int read_partitions(FILE *iso, struct partition **parts)
+{
+	struct iso_source is;
+	off_t size;
+	int n = 0, rc;
+
+	*parts = NULL;
+	/* st_size is 0 for a block device */
+	size = lseek(fileno(iso), 0, SEEK_END);
+	if (size < 0)
+		return -errno;
+	rc = iso_source_init(&is, iso, 0, size);
+	if (rc < 0)
+		return rc;
+
+	rc = read_apm(iso, parts, &n);
+	if (rc == 0)
+		rc = read_mbr(&is.src, parts, &n);
+	if (rc == 0)
+		rc = read_gpt(&is.src, parts, &n);
+	iso_source_fini(&is);
+	if (rc < 0) {
+		free(*parts);
+		*parts = NULL;
+		return rc;
+	}
+	return n;
+}
+
+static int get_partitions(struct context *context, struct partition **parts)
+{
+	int n = read_partitions(context->iso, parts);
+
+	if (n < 0)
+		fprintf(stderr, "dumpet: %s\n", strerror(-n));
+	else if (n == 0)
+		fprintf(stderr, "dumpet: no partition table in \"%s\"\n",
+			context->filename);
+	return n;
+}
+
+static void print_partition(struct partition *part)
+{
+	printf("%s partition %d: ", schemes[part->scheme].label, part->index);
+	if (part->name[0])
+		printf("\"%s\" ", part->name);
+	printf("(%s), %" PRIu64 " bytes at %" PRIu64 "\n", part->type,
+	       part->size, part->offset);
+}
+
+int list_partitions(struct context *context)
+{
+	struct partition *parts;
+	int i, n;
+
+	n = get_partitions(context, &parts);
+	if (n <= 0)
+		return n < 0 ? 3 : 5;
+	for (i = 0; i < n; i++)
+		print_partition(&parts[i]);
+	free(parts);
+	return 0;
+}
+
+struct selector {
+	const char *arg;
+	int scheme;		/* or -1 for any */
+	int index;		/* or 0 to go by type */
+	const char *type;
+};
+
+/* [<scheme>:]<index> or [<scheme>:]<type> */
+static int parse_selector(const char *arg, struct selector *sel)
+{
+	const char *colon = strchr(arg, ':');
+	const char *rest = arg;
+	int i;
+
+	sel->arg = arg;
+	sel->scheme = -1;
+	sel->index = 0;
+	sel->type = NULL;
+	if (colon) {
+		for (i = 0; i < sizeof(schemes) / sizeof(schemes[0]); i++)
+			if (strlen(schemes[i].name) == colon - arg &&
+					!strncasecmp(arg, schemes[i].name,
+						     colon - arg))
+				sel->scheme = i;
+		if (sel->scheme < 0) {
+			fprintf(stderr, "dumpet: unknown partition table "
+				"\"%.*s\" (apm, mbr or gpt)\n",
+				(int)(colon - arg), arg);
+			return -1;
+		}
+		rest = colon + 1;
+	}
+	if (!*rest) {
+		fprintf(stderr, "dumpet: bad partition \"%s\"\n", arg);
+		return -1;
+	}
+	if (strspn(rest, "0123456789") == strlen(rest)) {
+		sel->index = atoi(rest);
+		if (sel->index <= 0) {
+			fprintf(stderr, "dumpet: bad partition \"%s\"\n", arg);
+			return -1;
+		}
+	} else {
+		sel->type = rest;
+	}
+	return 0;
+}
+
+static int selector_matches(struct selector *sel, struct partition *part)
+{
+	if (sel->scheme >= 0 && part->scheme != sel->scheme)
+		return 0;
+	if (sel->index)
+		return part->index == sel->index;
+	if (!strcasecmp(sel->type, "esp"))
+		return (part->scheme == SchemeMbr &&
+				!strcmp(part->type, "0xef")) ||
+		       (part->scheme == SchemeGpt &&
+				!strcmp(part->type, ESP_GUID));
+	if (part->scheme == SchemeMbr) {
+		char *end;
+		unsigned long type = strtoul(sel->type, &end, 16);
+
+		return !*end && type == strtoul(part->type, NULL, 16);
+	}
+	return !strcasecmp(part->type, sel->type);
+}
+
+static int extract_partition(struct context *context,
+			     struct partition *part)
+{
+	uint64_t copied = 0;
+	char *path;
+	FILE *file;
+	int rc;
+
+	if (asprintf(&path, "%s.%s%d", output_prefix(context),
+		     schemes[part->scheme].name, part->index) < 0) {
+		fprintf(stderr, "dumpet: %m\n");
+		return 3;
+	}
+	unlink(path);
+	file = fopen(path, "w+");
+	if (!file) {
+		fprintf(stderr, "Could not open \"%s\": %m\n", path);
+		free(path);
+		return 3;
+	}
+	rc = copy_image_range(context->iso, part->offset, part->size, file,
+			      &copied);
+	if (fclose(file) != 0 && rc == 0)
+		rc = -errno;
+	if (rc < 0) {
+		fprintf(stderr, "dumpet: Error writing \"%s\": %s\n", path,
+			strerror(-rc));
+		free(path);
+		return 3;
+	}
+
+	printf("%s partition %d: %" PRIu64 " bytes written to %s\n",
+	       schemes[part->scheme].label, part->index, copied, path);
+	free(path);
+	if (copied < part->size) {
+		fprintf(stderr, "dumpet: %s partition %d runs past the end of "
+			"the image; %" PRIu64 " of its %" PRIu64 " bytes are "
+			"missing\n", schemes[part->scheme].label, part->index,
+			part->size - copied, part->size);
+		return 1;
+	}
+	return 0;
+}
+
+int extract_partitions(struct context *context)
+{
+	struct selector *sels;
+	struct partition *parts;
+	int *chosen;		/* the selector that picked it, plus one */
+	int i, j, k, n, rc = 0;
+
+	sels = calloc(context->npartitions, sizeof(*sels));
+	if (!sels) {
+		fprintf(stderr, "dumpet: %m\n");
+		return 3;
+	}
+	for (i = 0; i < context->npartitions; i++) {
+		if (parse_selector(context->partitions[i], &sels[i]) < 0) {
+			free(sels);
+			return 2;
+		}
+	}
+
+	n = get_partitions(context, &parts);
+	if (n <= 0) {
+		free(sels);
+		return n < 0 ? 3 : 5;
+	}
+	chosen = calloc(n, sizeof(*chosen));
+	if (!chosen) {
+		fprintf(stderr, "dumpet: %m\n");
+		free(sels);
+		free(parts);
+		return 3;
+	}
+
+	for (i = 0; i < context->npartitions; i++) {
+		struct selector *sel = &sels[i];
+		int matched = 0, first = -1;
+
+		for (j = 0; j < n; j++) {
+			if (!selector_matches(sel, &parts[j]))
+				continue;
+			if (first >= 0 && sel->index &&
+					parts[j].scheme != parts[first].scheme) {
+				fprintf(stderr, "dumpet: \"%s\" is in more "
+					"than one partition table; say which, "
+					"as in %s:%d\n", sel->arg,
+					schemes[parts[first].scheme].name,
+					sel->index);
+				rc = 2;
+				goto out;
+			}
+			if (first < 0)
+				first = j;
+			matched++;
+			/* hybrid tables describe the same partition twice,
+			 * so a type can match it in each */
+			for (k = 0; sel->type && k < j; k++)
+				if (chosen[k] == i + 1 &&
+						parts[k].offset == parts[j].offset &&
+						parts[k].size == parts[j].size)
+					break;
+			if (!sel->type || k == j)
+				chosen[j] = i + 1;
+		}
+		if (!matched) {
+			fprintf(stderr, "dumpet: no partition matches \"%s\"\n",
+				sel->arg);
+			rc = 5;
+			goto out;
+		}
+	}
+
+	stats_phase_begin(PhaseExtract);
+	for (j = 0; j < n; j++) {
+		int err;
+
+		if (!chosen[j])
+			continue;
+		err = extract_partition(context, &parts[j]);
+		if (err && !rc)
+			rc = err;
+	}
+	stats_phase_end(PhaseExtract);
+out:
+	free(chosen);
+	free(parts);
+	free(sels);
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <stdint.h>
+
+#include "dumpet.h"
+
+typedef enum {
+	SchemeApm,
+	SchemeMbr,
+	SchemeGpt,
+} PartitionScheme;
+
+struct partition {
+	PartitionScheme scheme;
+	int index;		/* numbered as the scheme numbers them */
+	uint64_t offset;	/* bytes from the start of the image */
+	uint64_t size;
+	char type[37];		/* APM type, MBR type byte, or GPT type GUID */
+	char name[109];		/* APM or GPT name, as UTF-8 */
+};
+
+/* Every partition in the Apple partition map, the MBR's primary entries
+ * and the GPT, in that order.  Returns the number found, or -errno. */
+extern int read_partitions(FILE *iso, struct partition **parts);
+
+/* --partitions: list them.  Returns 5 if the image has none. */
+extern int list_partitions(struct context *context);
+
+/* --partition: copy each partition a selector in context->partitions
+ * matches into <image>.<scheme><index>. */
+extern int extract_partitions(struct context *context);
+
+#endif /* PARTITION_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#include <errno.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pe.h"
+#include "fat.h"
+#include "endian.h"
+
+#define PE_MAX_HEADERS (1024 * 1024)
+#define PE_MAX_SECTIONS 96
+#define PE_HASH_CHUNK 65536
+
+struct pe_section {
+	uint32_t offset;
+	uint32_t size;
+};
+
+static inline uint16_t get_le16(const uint8_t *p)
+{
+	uint16_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return le16_to_cpu(v);
+}
+
+static inline uint32_t get_le32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return le32_to_cpu(v);
+}
+
+const char *pe_machine_name(uint16_t machine)
+{
+	switch (machine) {
+		case 0x014c: return "i386";
+		case 0x8664: return "x86-64";
+		case 0x01c2:
+		case 0x01c4: return "ARM";
+		case 0xaa64: return "AArch64";
+		case 0x5064: return "RISC-V 64";
+		case 0x6264: return "LoongArch 64";
+	}
+	return "unknown machine";
+}
+
+static int compare_sections(const void *a, const void *b)
+{
+	const struct pe_section *sa = a, *sb = b;
+
+	return sa->offset < sb->offset ? -1 : sa->offset > sb->offset;
+}
+
+static int hash_range(struct byte_source *src, struct sha256_ctx *ctx,
+		      uint8_t *buf, uint64_t offset, uint64_t len)
+{
+	while (len) {
+		size_t n = len < PE_HASH_CHUNK ? len : PE_HASH_CHUNK;
+		ssize_t rc = source_read(src, offset, buf, n);
+
+		if (rc < 0)
+			return rc;
+		if (rc < n)
+			return -EINVAL;		/* truncated */
+		sha256_update(ctx, buf, n);
+		offset += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/* Authenticode (the "Windows Authenticode Portable Executable Signature
+ * Format" document): everything in the headers but the checksum and the
+ * certificate table's directory entry, then each section in file order,
+ * then whatever follows the sections except the certificate table. */
+int pe_authenticode(struct byte_source *src, int exact,
+		    uint8_t digest[SHA256_DIGEST_SIZE], uint16_t *machine)
+{
+	struct pe_section sections[PE_MAX_SECTIONS];
+	struct sha256_ctx ctx;
+	uint8_t *hdr = NULL, *buf = NULL;
+	uint8_t dos[64];
+	uint32_t lfanew, opt, optsize, soh, ddir, nrva;
+	uint32_t checksum, certdir = 0, cert_offset = 0, cert_size = 0;
+	uint64_t hashed, end, file_size;
+	int i, nsections, n;
+	ssize_t rc;
+
+	rc = source_read(src, 0, dos, sizeof(dos));
+	if (rc < 0)
+		return rc;
+	if (rc < sizeof(dos) || dos[0] != 'M' || dos[1] != 'Z')
+		return -EINVAL;
+	lfanew = get_le32(dos + 0x3c);
+	opt = lfanew + 24;
+	if (lfanew > PE_MAX_HEADERS - 24 - 112)
+		return -EINVAL;
+
+	/* the COFF and optional headers, up to the data directories */
+	hdr = malloc(opt + 112);
+	if (!hdr)
+		return -errno;
+	rc = source_read(src, 0, hdr, opt + 112);
+	if (rc < 0)
+		goto out;
+	if (rc < opt + 112 || memcmp(hdr + lfanew, "PE\0\0", 4)) {
+		rc = -EINVAL;
+		goto out;
+	}
+	rc = -EINVAL;
+	*machine = get_le16(hdr + lfanew + 4);
+	nsections = get_le16(hdr + lfanew + 6);
+	optsize = get_le16(hdr + lfanew + 20);
+
+	switch (get_le16(hdr + opt)) {
+		case 0x10b:		/* PE32 */
+			ddir = 96;
+			break;
+		case 0x20b:		/* PE32+ */
+			ddir = 112;
+			break;
+		default:
+			goto out;
+	}
+	if (optsize < ddir || nsections > PE_MAX_SECTIONS)
+		goto out;
+	soh = get_le32(hdr + opt + 60);
+	checksum = opt + 64;
+	nrva = get_le32(hdr + opt + ddir - 4);
+	if (soh > PE_MAX_HEADERS || soh < opt + optsize + nsections * 40)
+		goto out;
+
+	/* and then everything through SizeOfHeaders */
+	buf = realloc(hdr, soh);
+	if (!buf) {
+		rc = -errno;
+		goto out;
+	}
+	hdr = buf;
+	buf = NULL;
+	rc = source_read(src, 0, hdr, soh);
+	if (rc < 0)
+		goto out;
+	if (rc < soh) {
+		rc = -EINVAL;
+		goto out;
+	}
+	if (nrva > 4 && ddir + 5 * 8 <= optsize) {
+		certdir = opt + ddir + 4 * 8;
+		cert_offset = get_le32(hdr + certdir);
+		cert_size = get_le32(hdr + certdir + 4);
+	}
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, hdr, checksum);
+	if (certdir) {
+		sha256_update(&ctx, hdr + checksum + 4, certdir - checksum - 4);
+		sha256_update(&ctx, hdr + certdir + 8, soh - certdir - 8);
+	} else {
+		sha256_update(&ctx, hdr + checksum + 4, soh - checksum - 4);
+	}
+
+	for (i = n = 0; i < nsections; i++) {
+		const uint8_t *sh = hdr + opt + optsize + i * 40;
+
+		sections[n].size = get_le32(sh + 16);
+		sections[n].offset = get_le32(sh + 20);
+		if (sections[n].size)
+			n++;
+	}
+	qsort(sections, n, sizeof(sections[0]), compare_sections);
+
+	buf = malloc(PE_HASH_CHUNK);
+	if (!buf) {
+		rc = -errno;
+		goto out;
+	}
+	hashed = end = soh;
+	for (i = 0; i < n; i++) {
+		rc = hash_range(src, &ctx, buf, sections[i].offset,
+				sections[i].size);
+		if (rc < 0)
+			goto out;
+		hashed += sections[i].size;
+		if (sections[i].offset + (uint64_t)sections[i].size > end)
+			end = sections[i].offset + (uint64_t)sections[i].size;
+	}
+
+	if (exact)
+		file_size = src->size;
+	else if (cert_size && cert_offset + (uint64_t)cert_size > end)
+		file_size = cert_offset + (uint64_t)cert_size;
+	else
+		file_size = end;
+	if (file_size > hashed + cert_size) {
+		rc = hash_range(src, &ctx, buf, hashed,
+				file_size - cert_size - hashed);
+		if (rc < 0)
+			goto out;
+	}
+
+	sha256_final(&ctx, digest);
+	rc = 0;
+out:
+	free(buf);
+	free(hdr);
+	return rc;
+}
+
+static int digest_fat_file(struct fat *fat, const char *path,
+			   uint32_t cluster, uint32_t size, void *priv)
+{
+	struct authenticode *result = priv;
+	struct authenticode_digest *d;
+	struct fat_file file;
+	uint8_t magic[2];
+	ssize_t rc;
+
+	fat_file_open(fat, &file, cluster, size);
+	rc = source_read(&file.src, 0, magic, sizeof(magic));
+	if (rc < 0)
+		return rc;
+	if (rc < sizeof(magic) || magic[0] != 'M' || magic[1] != 'Z')
+		return 0;
+
+	if (result->ndigests == MAX_AUTHENTICODE_DIGESTS) {
+		result->dropped++;
+		return 0;
+	}
+	d = &result->digests[result->ndigests];
+	rc = pe_authenticode(&file.src, 1, d->digest, &d->machine);
+	if (rc == -EINVAL) {
+		fprintf(stderr, "dumpet: %s is not a valid PE image\n", path);
+		return 0;
+	}
+	if (rc < 0)
+		return rc;
+	snprintf(d->path, sizeof(d->path), "%s", path);
+	result->ndigests++;
+	return 0;
+}
+
+int authenticode_boot_image(struct byte_source *src, int exact,
+			    struct authenticode *result)
+{
+	struct fat fat;
+	uint8_t magic[2];
+	ssize_t rc;
+
+	memset(result, '\0', sizeof(*result));
+
+	rc = source_read(src, 0, magic, sizeof(magic));
+	if (rc < 0)
+		return rc;
+	if (rc == sizeof(magic) && magic[0] == 'M' && magic[1] == 'Z') {
+		struct authenticode_digest *d = &result->digests[0];
+
+		rc = pe_authenticode(src, exact, d->digest, &d->machine);
+		if (rc == 0)
+			result->ndigests = 1;
+		return rc;
+	}
+
+	rc = fat_open(&fat, src);
+	if (rc == -EINVAL)
+		return 0;		/* neither; nothing to hash */
+	if (rc < 0)
+		return rc;
+	rc = fat_walk(&fat, digest_fat_file, result);
+	fat_close(&fat);
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PE_H
+#define PE_H
+
+#include <stdint.h>
+
+#include "sha256.h"
+#include "source.h"
+
+/* Authenticode digests of the PE/COFF binaries a boot image holds: the
+ * image itself if it's an EFI binary, or every PE file in it if it's a
+ * FAT image.  path is empty for the former. */
+
+#define MAX_AUTHENTICODE_DIGESTS 32
+
+struct authenticode_digest {
+	char path[256];
+	uint16_t machine;
+	uint8_t digest[SHA256_DIGEST_SIZE];
+};
+
+struct authenticode {
+	int ndigests;
+	int dropped;		/* PE files past MAX_AUTHENTICODE_DIGESTS */
+	struct authenticode_digest digests[MAX_AUTHENTICODE_DIGESTS];
+};
+
+extern const char *pe_machine_name(uint16_t machine);
+
+/* The Authenticode SHA-256 of the PE binary in src.  If exact is zero,
+ * src->size is only an upper bound and the file is taken to end with its
+ * last section or its certificate table.  Returns 0, -EINVAL if it isn't
+ * a well formed PE binary, or -errno. */
+extern int pe_authenticode(struct byte_source *src, int exact,
+			   uint8_t digest[SHA256_DIGEST_SIZE],
+			   uint16_t *machine);
+
+extern int authenticode_boot_image(struct byte_source *src, int exact,
+				   struct authenticode *result);
+
+#endif /* PE_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,124 @@
+#!/bin/sh
+#
+# Copyright 2026 Red Hat, Inc.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Run each scenario over the corpus with --stats and compare the reads,
+# writes, seeks and bytes read and written that dumpet reports with
+# perf/baseline.
+#
+# usage: iocounts.sh check|update <corpus dir> <baseline>
+#
+# These counts don't depend on the builder, its load or its clock, so
+# unlike timings they can be compared exactly.  A scenario fails when any
+# count rises more than PERF_THRESHOLD percent (default 0) over the
+# baseline, or when the baseline has nothing for it.
+
+mode=$1
+corpus=$2
+baseline=$3
+PERF_THRESHOLD=${PERF_THRESHOLD:-0}
+
+if [ $# -ne 3 ] || { [ "$mode" != check ] && [ "$mode" != update ]; }; then
+	echo "usage: $0 check|update <corpus dir> <baseline>" >&2
+	exit 2
+fi
+
+out=$corpus/results
+rm -rf "$out"
+mkdir -p "$out" || exit 3
+: >"$out/counts"
+
+# -d writes each boot image next to the image it reads, so the extract
+# scenario reads the corpus through a link in a directory of its own
+tmp=$(mktemp -d) || exit 3
+trap 'rm -rf "$tmp"' EXIT
+ln -s "$(cd "$corpus" && pwd)/eltorito.iso" "$tmp/eltorito.iso" || exit 3
+
+scenario() {
+	name=$1
+	shift
+	if ! "$@" --stats >"$out/$name.out" 2>"$out/$name.log"; then
+		echo "perf: scenario $name failed; see $out/$name.log" >&2
+		exit 3
+	fi
+	# reads, writes, seeks, bytes read and bytes written
+	awk -v name="$name" '
+		$1 == "total" {
+			printf "%s %d %d %d %d %d\n", name, $3, $4, $5, $6, $7
+		}' "$out/$name.log" >>"$out/counts"
+}
+
+scenario probe ./dumpet -i "$corpus/eltorito.iso" --probe
+scenario lint ./dumpet -i "$corpus/eltorito.iso" --lint
+scenario text ./dumpet -i "$corpus/eltorito.iso"
+scenario xml ./dumpet -i "$corpus/eltorito.iso" -x
+scenario extract ./dumpet -i "$tmp/eltorito.iso" -d
+scenario apm ./dumpet -i "$corpus/apm.img" --partitions
+
+if [ "$mode" = update ]; then
+	{
+		echo "# scenario reads writes seeks bytes-read bytes-written"
+		echo "#"
+		echo "# Recorded with \"make perf-baseline\"; \"make perf\" fails when a"
+		echo "# count rises past PERF_THRESHOLD percent of these."
+		sort "$out/counts"
+	} >"$out/baseline" && mv "$out/baseline" "$baseline" || exit 3
+	cat "$baseline"
+	exit 0
+fi
+
+if ! grep -q '^[^#]' "$baseline" 2>/dev/null; then
+	echo "perf: no counts in $baseline; run \"make perf-baseline\"" >&2
+	exit 1
+fi
+
+awk -v threshold="$PERF_THRESHOLD" '
+	BEGIN {
+		label[1] = "reads"
+		label[2] = "writes"
+		label[3] = "seeks"
+		label[4] = "bytes read"
+		label[5] = "bytes written"
+	}
+	FNR == NR {
+		if ($1 !~ /^#/ && NF > 1) {
+			known[$1] = 1
+			for (i = 2; i <= NF; i++)
+				old[$1, i - 1] = $i
+		}
+		next
+	}
+	function cmp(what, old, new) {
+		printf "  %-14s %12d -> %12d", what, old, new
+		if (old > 0)
+			printf " (%+.2f%%)", (new - old) * 100 / old
+		if (new > old * (100 + threshold) / 100) {
+			printf " REGRESSION"
+			failed = 1
+		}
+		printf "\n"
+	}
+	{
+		print $1 ":"
+		if (!($1 in known)) {
+			printf "  no baseline; run \"make perf-baseline\"\n"
+			failed = 1
+			next
+		}
+		for (i = 2; i <= NF; i++)
+			cmp(label[i - 1], old[$1, i - 1], $i)
+	}
+	END { exit failed }' "$baseline" "$out/counts" || exit 1
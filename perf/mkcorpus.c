@@ -0,0 +1,329 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mkcorpus -- write the synthetic images that "make perf" measures.
+ *
+ * Everything here is generated from fixed data and a fixed-seed PRNG, so
+ * the corpus is byte-for-byte identical on every builder and the counts
+ * measured against it are comparable.  This only uses
+ * libc so that it can't pick up behaviour changes from the code under
+ * test.
+ */
+
+#define _GNU_SOURCE 1
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SECTOR 2048
+
+/* layout of eltorito.iso, in 2048-byte sectors */
+#define PVD_LBA		16
+#define BR_LBA		17
+#define TERM_LBA	18
+#define ROOT_LBA	19
+#define CATALOG_LBA	20
+#define X86_LBA		21
+#define X86_SECTORS	4
+#define EFI_LBA		32
+#define EFI_SECTORS	1024
+#define FLOPPY_LBA	(EFI_LBA + EFI_SECTORS)
+#define FLOPPY_SECTORS	720
+#define VOLUME_SECTORS	(FLOPPY_LBA + FLOPPY_SECTORS)
+
+static uint32_t seed = 0x2545f491;
+
+static uint8_t prng(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+static void set721(uint8_t *p, uint16_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static void set731(uint8_t *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static void set732(uint8_t *p, uint32_t v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+static void set723(uint8_t *p, uint16_t v)
+{
+	set721(p, v);
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+static void set733(uint8_t *p, uint32_t v)
+{
+	set731(p, v);
+	set732(p + 4, v);
+}
+
+static void pad(uint8_t *p, const char *s, size_t n)
+{
+	size_t len = strlen(s);
+
+	memset(p, ' ', n);
+	memcpy(p, s, len < n ? len : n);
+}
+
+static int dirent(uint8_t *p, const char *name, uint32_t extent,
+		  uint32_t size, int dir)
+{
+	/* "\0" and "\1" are the names of "." and ".." */
+	size_t namelen = name[0] ? strlen(name) : 1;
+	int len = 33 + namelen + !(namelen & 1);
+
+	p[0] = len;
+	set733(p + 2, extent);
+	set733(p + 10, size);
+	p[18] = 126;		/* 2026 */
+	p[19] = 1;
+	p[20] = 1;
+	p[25] = dir ? 2 : 0;
+	set723(p + 28, 1);
+	p[32] = namelen;
+	memcpy(p + 33, name, namelen);
+	return len;
+}
+
+static void catalog(uint8_t *cat)
+{
+	uint16_t sum = 0;
+	uint8_t *e;
+	int i;
+
+	/* validation entry */
+	cat[0] = 0x01;
+	cat[1] = 0x00;
+	memcpy(cat + 4, "DUMPET PERF CORPUS", 18);
+	cat[30] = 0x55;
+	cat[31] = 0xaa;
+	for (i = 0; i < 32; i += 2)
+		sum += cat[i] | cat[i + 1] << 8;
+	set721(cat + 28, -sum);
+
+	/* default entry: x86, no emulation */
+	e = cat + 32;
+	e[0] = 0x88;
+	set721(e + 6, X86_SECTORS);
+	set731(e + 8, X86_LBA);
+
+	/* final section header: EFI, two entries */
+	e = cat + 64;
+	e[0] = 0x91;
+	e[1] = 0xef;
+	set721(e + 2, 2);
+
+	/* EFI, no emulation */
+	e = cat + 96;
+	e[0] = 0x88;
+	set721(e + 6, EFI_SECTORS);
+	set731(e + 8, EFI_LBA);
+
+	/* 1.44MB floppy emulation */
+	e = cat + 128;
+	e[0] = 0x88;
+	e[1] = 0x02;
+	set721(e + 6, 1);
+	set731(e + 8, FLOPPY_LBA);
+}
+
+static int write_eltorito(const char *path)
+{
+	uint8_t *img;
+	uint8_t *s;
+	FILE *f;
+	size_t i;
+	int off;
+
+	img = calloc(VOLUME_SECTORS, SECTOR);
+	if (!img)
+		return -1;
+
+	s = img + PVD_LBA * SECTOR;
+	s[0] = 1;
+	memcpy(s + 1, "CD001", 5);
+	s[6] = 1;
+	pad(s + 8, "LINUX", 32);
+	pad(s + 40, "DUMPET_PERF", 32);
+	set733(s + 80, VOLUME_SECTORS);
+	set723(s + 120, 1);
+	set723(s + 124, 1);
+	set723(s + 128, SECTOR);
+	dirent(s + 156, "\0", ROOT_LBA, SECTOR, 1);
+	s[881] = 1;
+
+	s = img + BR_LBA * SECTOR;
+	s[0] = 0;
+	memcpy(s + 1, "CD001", 5);
+	s[6] = 1;
+	memcpy(s + 7, "EL TORITO SPECIFICATION", 23);
+	set731(s + 71, CATALOG_LBA);
+
+	s = img + TERM_LBA * SECTOR;
+	s[0] = 255;
+	memcpy(s + 1, "CD001", 5);
+	s[6] = 1;
+
+	s = img + ROOT_LBA * SECTOR;
+	off = dirent(s, "\0", ROOT_LBA, SECTOR, 1);
+	off += dirent(s + off, "\1", ROOT_LBA, SECTOR, 1);
+	off += dirent(s + off, "BOOT.CAT;1", CATALOG_LBA, SECTOR, 0);
+	off += dirent(s + off, "ISOLINUX.BIN;1", X86_LBA,
+		      X86_SECTORS * 512, 0);
+	off += dirent(s + off, "EFIBOOT.IMG;1", EFI_LBA,
+		      EFI_SECTORS * SECTOR, 0);
+	dirent(s + off, "FLOPPY.IMG;1", FLOPPY_LBA, FLOPPY_SECTORS * SECTOR, 0);
+
+	catalog(img + CATALOG_LBA * SECTOR);
+
+	/* boot code is just noise */
+	s = img + X86_LBA * SECTOR;
+	for (i = 0; i < X86_SECTORS * 512; i++)
+		s[i] = prng();
+
+	/* a FAT image is mostly noise with long zero runs */
+	s = img + EFI_LBA * SECTOR;
+	for (i = 0; i < EFI_SECTORS * SECTOR; i++)
+		s[i] = (i / (64 * 1024)) % 3 == 2 ? 0 : prng();
+
+	/* a floppy is a boot sector and almost nothing else */
+	s = img + FLOPPY_LBA * SECTOR;
+	for (i = 0; i < 512; i++)
+		s[i] = prng();
+	s[510] = 0x55;
+	s[511] = 0xaa;
+
+	f = fopen(path, "w");
+	if (!f) {
+		free(img);
+		return -1;
+	}
+	if (fwrite(img, SECTOR, VOLUME_SECTORS, f) != VOLUME_SECTORS) {
+		fclose(f);
+		free(img);
+		return -1;
+	}
+	free(img);
+	return fclose(f);
+}
+
+/* An Apple partition map with 512-byte blocks: the driver descriptor map,
+ * the map's own entry, and a few partitions. */
+static int write_apm(const char *path)
+{
+	static const struct {
+		const char *name;
+		const char *type;
+		uint32_t start;
+		uint32_t blocks;
+		uint32_t flags;
+	} parts[] = {
+		{ "Apple", "Apple_partition_map", 1, 63, 0x3 },
+		{ "EFI", "Apple_HFS", 64, 2048, 0x33 },
+		{ "Recovery", "Apple_HFS", 2112, 1024, 0x33 },
+		{ "Free", "Apple_Free", 3136, 960, 0x0 },
+	};
+	const int nparts = sizeof(parts) / sizeof(parts[0]);
+	const uint32_t blocks = 4096;
+	uint8_t *img;
+	FILE *f;
+	int i;
+
+	img = calloc(blocks, 512);
+	if (!img)
+		return -1;
+
+	img[0] = 'E';
+	img[1] = 'R';
+	img[2] = 512 >> 8;
+	img[3] = 512 & 0xff;
+	set732(img + 4, blocks);
+
+	for (i = 0; i < nparts; i++) {
+		uint8_t *e = img + (i + 1) * 512;
+
+		e[0] = 'P';
+		e[1] = 'M';
+		set732(e + 4, nparts);
+		set732(e + 8, parts[i].start);
+		set732(e + 12, parts[i].blocks);
+		strncpy((char *)e + 16, parts[i].name, 32);
+		strncpy((char *)e + 48, parts[i].type, 32);
+		set732(e + 84, parts[i].blocks);
+		set732(e + 88, parts[i].flags);
+	}
+
+	f = fopen(path, "w");
+	if (!f) {
+		free(img);
+		return -1;
+	}
+	if (fwrite(img, 512, blocks, f) != blocks) {
+		fclose(f);
+		free(img);
+		return -1;
+	}
+	free(img);
+	return fclose(f);
+}
+
+int main(int argc, char *argv[])
+{
+	char *path;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: mkcorpus <directory>\n");
+		return 2;
+	}
+
+	if (asprintf(&path, "%s/eltorito.iso", argv[1]) < 0 ||
+			write_eltorito(path) < 0) {
+		fprintf(stderr, "mkcorpus: could not write \"%s\": %m\n", path);
+		return 3;
+	}
+	free(path);
+
+	if (asprintf(&path, "%s/apm.img", argv[1]) < 0 ||
+			write_apm(path) < 0) {
+		fprintf(stderr, "mkcorpus: could not write \"%s\": %m\n", path);
+		return 3;
+	}
+	free(path);
+	return 0;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
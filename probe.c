@@ -0,0 +1,155 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dumpet.h"
+#include "catalog.h"
+#include "endian.h"
+#include "probe.h"
+#include "volume.h"
+
+/* Append the platform of each entry to buf, once per platform, in
+ * catalog order. */
+static void list_platforms(char *buf, size_t n, struct boot_catalog *cat)
+{
+	int seen[256] = { 0 };
+	size_t len = 0;
+	int i;
+
+	buf[0] = '\0';
+	for (i = 0; i < cat->nentries && len < n; i++) {
+		uint8_t platform = cat->entries[i].PlatformId;
+		char name[32];
+
+		if (seen[platform]++)
+			continue;
+		snprintPlatformId(name, sizeof(name), platform);
+		len += snprintf(buf + len, n - len, "%s%s", len ? ", " : "",
+				name);
+	}
+}
+
+/* Where El Torito says the boot record goes: sector 17, right after the
+ * primary volume descriptor.  Returns its catalog sector, or 0 if it isn't
+ * there. */
+static uint32_t find_boot_record_fast(Sector descriptors[2])
+{
+	PrimaryVolumeDescriptor *pvd =
+		(PrimaryVolumeDescriptor *)&descriptors[0];
+	BootRecordVolumeDescriptor *br =
+		(BootRecordVolumeDescriptor *)&descriptors[1];
+
+	if (memcmp(pvd->Iso9660, "CD001", 5) ||
+			br->BootRecordIndicator != BootRecordDescriptor ||
+			memcmp(br->Iso9660, "CD001", 5) ||
+			strncmp(br->BootSystemId, "EL TORITO SPECIFICATION",
+				sizeof(br->BootSystemId)))
+		return 0;
+	return iso731_to_cpu32(br->BootCatalogLBA);
+}
+
+int probe_image(struct context *context)
+{
+	Sector descriptors[2];
+	struct descriptor_set *set;
+	struct boot_catalog *cat;
+	char platforms[256];
+	uint32_t lba = 0;
+	int bootable = 0;
+	int checksum_ok;
+	int i, rc;
+
+	stats_phase_begin(PhaseBootRecord);
+	rc = read_sectors_upto(context->iso, 16, 2, descriptors);
+	if (rc == 2)
+		lba = find_boot_record_fast(descriptors);
+
+	/* anything else gets the whole descriptor set searched, the way a
+	 * full dump would */
+	if (rc >= 0 && !lba) {
+		set = malloc(sizeof(*set));
+		if (!set) {
+			stats_phase_end(PhaseBootRecord);
+			fprintf(stderr, "dumpet: %m\n");
+			return 3;
+		}
+		rc = read_descriptor_set(context->iso, set);
+		if (rc >= 0 && set->boot_record < 0)
+			rc = set->ndescriptors ? 5 : 6;
+		else if (rc >= 0)
+			lba = set->BootCatalogLBA;
+		free(set);
+	}
+	stats_phase_end(PhaseBootRecord);
+	if (rc < 0)
+		return 3;
+	if (rc == 5 || rc == 6) {
+		printf("%s: %s\n", context->filename, rc == 6 ?
+		       "not an ISO 9660 image" : "no El Torito boot record");
+		return rc;
+	}
+
+	cat = malloc(sizeof(*cat));
+	if (!cat) {
+		fprintf(stderr, "dumpet: %m\n");
+		return 3;
+	}
+
+	stats_phase_begin(PhaseCatalog);
+	rc = read_boot_catalog(context->iso, lba, cat);
+	stats_phase_end(PhaseCatalog);
+	if (rc < 0) {
+		free(cat);
+		return 4;
+	}
+
+	/* summarize what is there even if the checksum is wrong */
+	checksum_ok = cat->checksum_ok;
+	if (!checksum_ok) {
+		fixValidationEntry(&cat->raw.Catalog[0].ValidationEntry);
+		parse_boot_catalog(cat);
+	}
+	if (cat->nheaders == 0 ||
+			cat->headers[0].HeaderIndicator != ValidationIndicator) {
+		printf("%s: El Torito, catalog at sector %u has no validation "
+		       "entry\n", context->filename, lba);
+		free(cat);
+		return 1;
+	}
+
+	for (i = 0; i < cat->nentries; i++)
+		if (cat->entries[i].BootIndicator == Bootable)
+			bootable++;
+	list_platforms(platforms, sizeof(platforms), cat);
+
+	printf("%s: El Torito, catalog at sector %u%s, %d entr%s "
+	       "(%d bootable)%s%s\n",
+	       context->filename, lba, checksum_ok ? "" : " (bad checksum)",
+	       cat->nentries, cat->nentries == 1 ? "y" : "ies", bootable,
+	       platforms[0] ? ": " : "", platforms);
+
+	free(cat);
+	return checksum_ok && bootable ? 0 : 1;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PROBE_H
+#define PROBE_H
+
+#include "dumpet.h"
+
+/* Print a one-line summary of the image's El Torito catalog, reading only
+ * sectors 16 and 17 and the catalog sector when the boot record is where
+ * El Torito puts it.  Returns 0 if there is at least one bootable entry,
+ * 1 if the catalog is bad or has none, and the same statuses as a full
+ * dump if there is no catalog to look at. */
+extern int probe_image(struct context *context);
+
+#endif /* PROBE_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
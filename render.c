@@ -0,0 +1,843 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "dumpet.h"
+#include "render.h"
+#include "simd.h"
+#include "classify.h"
+#include "bootinfo.h"
+#include "pe.h"
+#include "source.h"
+#include "store.h"
+#include "volume.h"
+
+static const struct renderer_ops *renderer_types[] = {
+	&text_renderer_ops,
+	&xml_renderer_ops,
+	&tar_renderer_ops,
+	&cpio_renderer_ops,
+	&fingerprint_renderer_ops,
+	&fingerprint_images_renderer_ops,
+	NULL
+};
+
+/* spec is "format[:path]"; no path or "-" means stdout. */
+int add_renderer(struct context *context, const char *spec)
+{
+	const struct renderer_ops *ops = NULL;
+	struct renderer *r, **tail;
+	const char *path = NULL;
+	size_t len;
+	int i;
+
+	len = strcspn(spec, ":");
+	if (spec[len] == ':')
+		path = spec + len + 1;
+
+	for (i = 0; renderer_types[i]; i++) {
+		if (strlen(renderer_types[i]->name) == len &&
+				!strncmp(renderer_types[i]->name, spec, len)) {
+			ops = renderer_types[i];
+			break;
+		}
+	}
+	if (!ops) {
+		fprintf(stderr, "dumpet: unknown output format \"%.*s\"\n",
+			(int)len, spec);
+		return -1;
+	}
+	if (ops->load && ops->load() < 0)
+		return -1;
+
+	r = calloc(1, sizeof(*r));
+	if (!r) {
+		fprintf(stderr, "dumpet: %m\n");
+		return -1;
+	}
+	r->ops = ops;
+
+	if (!path || !*path || !strcmp(path, "-")) {
+		r->out = stdout;
+	} else {
+		r->path = strdup(path);
+		r->out = fopen(path, "w");
+		if (!r->path || !r->out) {
+			fprintf(stderr, "Could not open \"%s\": %m\n", path);
+			if (r->out)
+				fclose(r->out);
+			free(r->path);
+			free(r);
+			return -1;
+		}
+	}
+
+	for (tail = &context->renderers; *tail; tail = &(*tail)->next)
+		;
+	*tail = r;
+	return 0;
+}
+
+/* Extraction reads each stretch of the image once: every entry's extent,
+ * sorted by LBA, with overlapping and adjacent ones merged into a run.
+ * Default and section entries often name the same image, or images laid
+ * out back to back, and this turns a seek per entry into one sequential
+ * read per run.  Each entry's image is then a slice of its run. */
+struct extent_run {
+	uint32_t lba;
+	uint32_t sectors;
+	uint32_t nread;		/* up to the first unreadable sector */
+	Sector *data;
+};
+
+struct extraction {
+	struct extent_run *runs;
+	int nruns;
+};
+
+/* If the source is sparse, the holes don't need to be read at all; fill
+ * in the data extents and leave the rest zeroed.  Returns 0 if it did
+ * the whole read, or -1 to fall back to reading everything.  The end of
+ * the file looks like one more hole, so an extent running past it is
+ * left to the fallback to read as far as it can. */
+static int load_sparse_extent(struct context *context, uint32_t lba,
+			      uint32_t sectors, Sector *buf)
+{
+	int fd = fileno(context->iso);
+	off_t start = get_sector_offset(lba);
+	off_t end = start + (off_t)sectors * sizeof(Sector);
+	off_t data, hole;
+	struct stat sb;
+
+	if (fstat(fd, &sb) < 0 || end > sb.st_size)
+		return -1;
+	hole = lseek(fd, start, SEEK_HOLE);
+	if (hole < 0 || hole >= end)
+		return -1;
+
+	memset(buf, '\0', sectors * sizeof(Sector));
+	for (data = start; data < end; data = hole) {
+		uint32_t first, last;
+
+		data = lseek(fd, data, SEEK_DATA);
+		if (data < 0 || data >= end)
+			break;
+		hole = lseek(fd, data, SEEK_HOLE);
+		if (hole < 0)
+			return -1;
+		if (hole > end)
+			hole = end;
+
+		/* extents needn't be sector aligned; round outwards */
+		first = (data - start) / sizeof(Sector);
+		last = (hole - start + sizeof(Sector) - 1) / sizeof(Sector);
+		if (read_sectors(context->iso, lba + first, last - first,
+				 &buf[first]) < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* Returns the number of sectors read before the first bad one. */
+static uint32_t read_extent(struct context *context, uint32_t lba,
+			    uint32_t sectors, Sector *buf)
+{
+	uint32_t i;
+
+	if (load_sparse_extent(context, lba, sectors, buf) == 0 ||
+			read_sectors(context->iso, lba, sectors, buf) == 0)
+		return sectors;
+
+	/* salvage whatever is readable up to the first bad sector; running
+	 * into the end of the image has been reported already */
+	for (i = 0; i < sectors; i++)
+		if (read_sectors_upto(context->iso, lba + i, 1, &buf[i]) != 1)
+			break;
+	return i;
+}
+
+static int compare_runs(const void *a, const void *b)
+{
+	const struct extent_run *x = a, *y = b;
+
+	if (x->lba != y->lba)
+		return x->lba < y->lba ? -1 : 1;
+	return 0;
+}
+
+static void plan_extraction(struct context *context, struct boot_catalog *cat,
+			    struct extraction *x)
+{
+	int h, e, n = 0, i;
+
+	memset(x, '\0', sizeof(*x));
+	x->runs = calloc(cat->nentries ? cat->nentries : 1, sizeof(*x->runs));
+	if (!x->runs)
+		return;
+
+	for (h = 0; h < cat->nheaders; h++) {
+		struct boot_header *header = &cat->headers[h];
+
+		for (e = 0; e < header->nentries; e++) {
+			struct boot_entry *entry = &header->entries[e];
+			uint32_t sectors;
+
+			sectors = boot_image_sectors(get_file_map(context),
+						     entry);
+			if (!sectors || n == cat->nentries)
+				continue;
+			x->runs[n].lba = entry->LoadLBA;
+			x->runs[n].sectors = sectors;
+			n++;
+		}
+	}
+	qsort(x->runs, n, sizeof(*x->runs), compare_runs);
+
+	for (i = 0; i < n; i++) {
+		struct extent_run *last = x->nruns ? &x->runs[x->nruns - 1]
+						   : NULL;
+		uint64_t end = (uint64_t)x->runs[i].lba + x->runs[i].sectors;
+
+		if (last && x->runs[i].lba <= (uint64_t)last->lba +
+					      last->sectors) {
+			if (end > (uint64_t)last->lba + last->sectors)
+				last->sectors = end - last->lba;
+			continue;
+		}
+		x->runs[x->nruns++] = x->runs[i];
+	}
+
+	for (i = 0; i < x->nruns; i++) {
+		struct extent_run *run = &x->runs[i];
+
+		run->data = malloc((size_t)run->sectors * sizeof(Sector));
+		if (run->data)
+			run->nread = read_extent(context, run->lba,
+						 run->sectors, run->data);
+	}
+}
+
+static void free_extraction(struct extraction *x)
+{
+	int i;
+
+	for (i = 0; i < x->nruns; i++)
+		free(x->runs[i].data);
+	free(x->runs);
+}
+
+static struct extent_run *find_run(struct extraction *x, uint32_t lba)
+{
+	int lo = 0, hi = x->nruns;
+
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		struct extent_run *run = &x->runs[mid];
+
+		if (lba < run->lba)
+			hi = mid;
+		else if (lba - run->lba >= run->sectors)
+			lo = mid + 1;
+		else
+			return run;
+	}
+	return NULL;
+}
+
+static void load_boot_image(struct context *context, struct extraction *x,
+			    struct boot_entry *entry, struct boot_image *image)
+{
+	struct extent_run *run;
+
+	memset(image, '\0', sizeof(*image));
+	image->sectors = boot_image_sectors(get_file_map(context), entry);
+	if (!image->sectors)
+		return;
+
+	run = find_run(x, entry->LoadLBA);
+	if (run && run->data && run->nread > entry->LoadLBA - run->lba) {
+		uint32_t offset = entry->LoadLBA - run->lba;
+
+		image->data = &run->data[offset];
+		image->nread = run->nread - offset;
+		if (image->nread > image->sectors)
+			image->nread = image->sectors;
+		image->shared = 1;
+	} else {
+		/* no memory for the run, or it went bad before this image
+		 * starts; this image alone may still be readable */
+		image->data = malloc(image->sectors * sizeof(Sector));
+		if (!image->data) {
+			fprintf(stderr, "dumpet: %m\n");
+			return;
+		}
+		image->nread = read_extent(context, entry->LoadLBA,
+					   image->sectors, image->data);
+	}
+	image->payload = trim_zeros(image->data, image->nread * sizeof(Sector));
+}
+
+/* Write the image out from the start of file; all-zero sectors are left
+ * as holes. */
+int write_boot_image(FILE *file, struct boot_image *image)
+{
+	uint32_t i, j;
+	int rc = 0;
+
+	for (i = 0; i < image->nread && rc == 0; i = j) {
+		while (i < image->nread &&
+				is_zero(&image->data[i], sizeof(Sector)))
+			i++;
+		for (j = i; j < image->nread; j++)
+			if (is_zero(&image->data[j], sizeof(Sector)))
+				break;
+		if (j > i)
+			rc = write_sectors(file, i, j - i, &image->data[i]);
+	}
+	if (rc == 0 && (fflush(file) != 0 ||
+			ftruncate(fileno(file), (off_t)image->nread *
+						sizeof(Sector)) < 0)) {
+		rc = -errno;
+		fprintf(stderr, "dumpet: Error writing image: %m\n");
+	}
+	return rc;
+}
+
+/* Copy through memory, for when the kernel won't copy between these two
+ * files; all-zero sectors are left as holes. */
+static int copy_range_buffered(int in, uint64_t offset, uint64_t length,
+			       int out, uint64_t *copied)
+{
+	const size_t chunk = 64 * sizeof(Sector);
+	uint8_t *buf = malloc(chunk);
+	int rc = 0;
+
+	if (!buf)
+		return -errno;
+	while (*copied < length) {
+		size_t want = length - *copied < chunk ? length - *copied : chunk;
+		ssize_t n = pread(in, buf, want, offset + *copied);
+		size_t i;
+
+		iostats.reads++;
+		if (n < 0) {
+			rc = -errno;
+			break;
+		}
+		if (n == 0)
+			break;
+		iostats.bytes_read += n;
+		for (i = 0; i < n && rc == 0; i += sizeof(Sector)) {
+			size_t len = n - i < sizeof(Sector) ? n - i :
+							      sizeof(Sector);
+
+			if (is_zero(buf + i, len))
+				continue;
+			if (pwrite(out, buf + i, len, *copied + i) != len) {
+				rc = errno ? -errno : -EIO;
+				break;
+			}
+			iostats.writes++;
+			iostats.bytes_written += len;
+		}
+		if (rc < 0)
+			break;
+		*copied += n;
+	}
+	free(buf);
+	return rc;
+}
+
+/* Copy length bytes from offset in the image to the start of out, a file
+ * just created; for ranges nothing has read into memory, since boot
+ * images are better written from their extent run.  The kernel does the
+ * copy where it can, which on a file system with reflinks shares the
+ * blocks rather than copying them.  *copied is short only if the image
+ * ends first. */
+int copy_image_range(FILE *iso, uint64_t offset, uint64_t length, FILE *out,
+		     uint64_t *copied)
+{
+	int in = fileno(iso), fd = fileno(out);
+	loff_t from = offset, to = 0;
+	int rc = 0;
+
+	*copied = 0;
+	if (fflush(out) != 0)
+		return -errno;
+	while (*copied < length) {
+		ssize_t n = copy_file_range(in, &from, fd, &to,
+					    length - *copied, 0);
+
+		if (n < 0) {
+			if (errno == ENOSYS || errno == EXDEV ||
+					errno == EINVAL || errno == EOPNOTSUPP)
+				rc = copy_range_buffered(in, offset, length,
+							 fd, copied);
+			else
+				rc = -errno;
+			break;
+		}
+		if (n == 0)
+			break;
+		iostats.reads++;
+		iostats.writes++;
+		iostats.bytes_read += n;
+		iostats.bytes_written += n;
+		*copied += n;
+	}
+	if (rc == 0 && ftruncate(fd, *copied) < 0)
+		rc = -errno;
+	return rc;
+}
+
+static int write_boot_image_file(struct context *context,
+				 struct boot_entry *entry,
+				 struct boot_image *image)
+{
+	FILE *file;
+	int rc;
+
+	rc = asprintf(&image->filename, "%s.%d", output_prefix(context),
+		      entry->filenum);
+	if (rc < 0) {
+		image->filename = NULL;
+		return rc;
+	}
+
+	/* with --store, the same bytes are already on disk */
+	if (entry->stored && entry->stored->path &&
+			store_link(entry->stored, image->filename) == 0)
+		return 0;
+
+	/* never write through a link left by an earlier --store run */
+	unlink(image->filename);
+	file = fopen(image->filename, "w+");
+	if (!file) {
+		int errnum = errno;
+		fprintf(stderr, "Could not open \"%s\": %m\n", image->filename);
+		return -errnum;
+	}
+	rc = write_boot_image(file, image);
+	fclose(file);
+	return rc;
+}
+
+/* The size of the file the entry points at, if it's in the hierarchy;
+ * SectorCount is often just what the firmware loads first. */
+static int boot_entry_file_size(struct context *context,
+				struct boot_entry *entry, uint32_t *size)
+{
+	struct file_map *map = get_file_map(context);
+	struct iso_file file;
+
+	if (!map || !find_file_by_extent(map, entry->LoadLBA, &file))
+		return 0;
+	*size = file.size;
+	return 1;
+}
+
+static void classify_boot_image(struct context *context,
+				struct boot_entry *entry,
+				struct boot_image *image,
+				struct classification *result)
+{
+	const uint32_t chunk = 64;
+	struct classifier c;
+	uint32_t sectors = boot_image_sectors(get_file_map(context), entry);
+	uint32_t done = 0;
+	Sector *buf;
+
+	if (classify_begin(&c, result) < 0) {
+		fprintf(stderr, "dumpet: %m\n");
+		return;
+	}
+
+	/* it's already in memory with -d */
+	if (image && image->nread >= sectors) {
+		classify_feed(&c, image->data, image->nread * sizeof(Sector));
+		classify_end(&c);
+		return;
+	}
+
+	buf = malloc(chunk * sizeof(Sector));
+	while (buf && done < sectors) {
+		int n = sectors - done < chunk ? sectors - done : chunk;
+
+		n = read_sectors_upto(context->iso, entry->LoadLBA + done, n,
+				      buf);
+		if (n <= 0)
+			break;
+		classify_feed(&c, buf, n * sizeof(Sector));
+		done += n;
+	}
+	free(buf);
+	classify_end(&c);
+}
+
+/* Where the descriptor set has the primary volume descriptor, which is
+ * what a boot info table should point at. */
+static uint32_t primary_lba(struct context *context)
+{
+	struct descriptor_set *set = context->volume;
+	int i;
+
+	for (i = 0; set && i < set->ndescriptors; i++)
+		if (!strcmp(set->descriptors[i].Id, "CD001") &&
+				set->descriptors[i].Type == PrimaryDescriptor)
+			return set->descriptors[i].lba;
+	return 16;
+}
+
+/* Sum the file through to the length the table gives, once, using what
+ * is already in memory with -d and reading only the rest.  Returns
+ * whether the image has a table. */
+static int check_boot_info(struct context *context, struct boot_entry *entry,
+			   struct boot_image *image, struct boot_info *result)
+{
+	const uint32_t chunk = 64;
+	uint32_t size = 0, sectors, done;
+	Sector *buf, *first;
+	int n, i;
+
+	buf = malloc(chunk * sizeof(Sector));
+	if (!buf) {
+		fprintf(stderr, "dumpet: %m\n");
+		return 0;
+	}
+	boot_entry_file_size(context, entry, &size);
+
+	if (image && image->nread) {
+		first = image->data;
+		n = image->nread;
+	} else {
+		/* no further than a stream would have kept */
+		sectors = boot_image_sectors(get_file_map(context), entry);
+		first = buf;
+		n = read_sectors_upto(context->iso, entry->LoadLBA,
+				      sectors < chunk ? sectors : chunk, buf);
+	}
+	if (n <= 0 || !boot_info_begin(result, first, n * sizeof(Sector),
+				       primary_lba(context), entry->LoadLBA,
+				       size)) {
+		free(buf);
+		return 0;
+	}
+
+	sectors = (result->FileLength + sizeof(Sector) - 1) / sizeof(Sector);
+	for (done = n; done < sectors; done += n) {
+		n = sectors - done < chunk ? sectors - done : chunk;
+		n = read_sectors_upto(context->iso, entry->LoadLBA + done, n,
+				      buf);
+		if (n <= 0)
+			break;
+		boot_info_feed(result, buf, n * sizeof(Sector));
+	}
+	free(buf);
+	boot_info_end(result);
+
+	if (result->problems) {
+		const char *sep = ": ";
+
+		fprintf(stderr, "dumpet: Boot info table in the image at LBA "
+			"%u is stale", entry->LoadLBA);
+		for (i = 0; i < BOOT_INFO_NPROBLEMS; i++) {
+			if (!(result->problems & (1 << i)))
+				continue;
+			fprintf(stderr, "%s%s", sep, boot_info_problem(i));
+			sep = ", ";
+		}
+		fprintf(stderr, "\n");
+	}
+	return 1;
+}
+
+/* Hash the binaries in place, straight from the image or from memory
+ * with -d; nothing is extracted.  Without a directory record to say how
+ * big the file is, SectorCount can't be trusted to cover it, so it may
+ * run to the end of the image; the PE or FAT headers bound the reads. */
+static void digest_boot_image(struct context *context,
+			      struct boot_entry *entry,
+			      struct boot_image *image,
+			      struct authenticode *result)
+{
+	struct iso_source is;
+	struct mem_source ms;
+	struct byte_source *src;
+	struct stat sb;
+	off_t start = get_sector_offset(entry->LoadLBA);
+	uint64_t size;
+	uint32_t file_size;
+	int exact, rc;
+
+	exact = boot_entry_file_size(context, entry, &file_size);
+	if (exact)
+		size = file_size;
+	else if (fstat(fileno(context->iso), &sb) == 0 && sb.st_size > start)
+		size = sb.st_size - start;
+	else
+		size = boot_entry_sectors(entry) * sizeof(Sector);
+
+	if (image && image->nread * sizeof(Sector) >= size) {
+		mem_source_init(&ms, image->data, size);
+		src = &ms.src;
+	} else {
+		if (iso_source_init(&is, context->iso, start, size) < 0) {
+			memset(result, '\0', sizeof(*result));
+			fprintf(stderr, "dumpet: %m\n");
+			return;
+		}
+		src = &is.src;
+	}
+
+	rc = authenticode_boot_image(src, exact, result);
+	if (rc == -EINVAL)
+		fprintf(stderr, "dumpet: Boot image at LBA %u is not a valid "
+			"PE image\n", entry->LoadLBA);
+	if (result->dropped)
+		fprintf(stderr, "dumpet: Only the first %d PE files in the "
+			"boot image at LBA %u were hashed\n",
+			MAX_AUTHENTICODE_DIGESTS, entry->LoadLBA);
+
+	if (src == &is.src)
+		iso_source_fini(&is);
+}
+
+/* The entries needn't be in LBA order, so a forward-only input has to be
+ * told about every boot image before the first one is read; each is
+ * kept from its first sector through the end of its file, if that's
+ * known, since that's as far as anything here will read. */
+static void plan_stream(struct context *context, struct boot_catalog *cat)
+{
+	int h, e;
+
+	for (h = 0; h < cat->nheaders; h++) {
+		struct boot_header *header = &cat->headers[h];
+
+		for (e = 0; e < header->nentries; e++) {
+			struct boot_entry *entry = &header->entries[e];
+			uint32_t sectors;
+
+			sectors = boot_image_sectors(get_file_map(context),
+						     entry);
+			if (stream_want(input_stream, entry->LoadLBA,
+					sectors) < 0)
+				fprintf(stderr, "dumpet: %m\n");
+		}
+	}
+}
+
+#define for_each_renderer(context, r) \
+	for (r = (context)->renderers; r; r = r->next)
+
+#define call_renderer(r, method, ...)				\
+	do {							\
+		if ((r)->ops->method) {				\
+			stats_phase_begin((r)->ops->phase);	\
+			(r)->ops->method((r), __VA_ARGS__);	\
+			stats_phase_end((r)->ops->phase);	\
+		}						\
+	} while (0)
+
+/* Walk the decoded catalog once, handing every header and entry (and,
+ * with --dumpdisks, every boot image) to each renderer in turn. */
+int render_catalog(struct context *context, struct boot_catalog *cat)
+{
+	struct renderer *r;
+	struct store *store = NULL;
+	struct extraction extraction = { 0 };
+	int want_files = 0;
+	int want_images = context->dumpDiskImage || context->storeDir;
+	int incomplete = 0;
+	int h, e;
+
+	for_each_renderer(context, r) {
+		int rc = 0;
+
+		if (r->ops->dumps_files && context->dumpDiskImage)
+			want_files = 1;
+		if (r->ops->wants_images)
+			want_images = 1;
+		stats_phase_begin(r->ops->phase);
+		if (r->ops->begin)
+			rc = r->ops->begin(r, context, cat);
+		stats_phase_end(r->ops->phase);
+		if (rc < 0)
+			return rc;
+	}
+
+	if (context->dumpVolume && context->volume)
+		for_each_renderer(context, r)
+			call_renderer(r, volume, context, context->volume);
+
+	if (!cat->checksum_ok)
+		return -1;
+
+	if (context->storeDir) {
+		store = store_open(context);
+		if (!store)
+			return -1;
+	}
+
+	if (input_stream)
+		plan_stream(context, cat);
+
+	if (want_images) {
+		stats_phase_begin(PhaseExtract);
+		plan_extraction(context, cat, &extraction);
+		stats_phase_end(PhaseExtract);
+	}
+
+	for (h = 0; h < cat->nheaders; h++) {
+		struct boot_header *header = &cat->headers[h];
+
+		for_each_renderer(context, r)
+			call_renderer(r, header, context, header);
+
+		for (e = 0; e < header->nentries; e++) {
+			struct boot_entry *entry = &header->entries[e];
+			struct boot_image image, *imagep = NULL;
+			struct classification classification;
+			struct authenticode authenticode;
+			struct boot_info boot_info;
+			struct store_object object;
+
+			if (want_images) {
+				stats_phase_begin(PhaseExtract);
+				load_boot_image(context, &extraction, entry,
+						&image);
+				if (image.nread < image.sectors) {
+					fprintf(stderr, "dumpet: only %u of "
+						"the %u sectors of boot image "
+						"%d could be read\n",
+						image.nread, image.sectors,
+						entry->filenum);
+					incomplete = 1;
+				}
+				/* the store holds whole images only */
+				if (store && image.data &&
+						image.nread == image.sectors) {
+					store_boot_image(store, entry, &image,
+							 &object);
+					entry->stored = &object;
+				}
+				if (want_files)
+					write_boot_image_file(context, entry,
+							      &image);
+				stats_phase_end(PhaseExtract);
+				imagep = &image;
+			}
+
+			if (context->classify) {
+				stats_phase_begin(PhaseClassify);
+				classify_boot_image(context, entry, imagep,
+						    &classification);
+				stats_phase_end(PhaseClassify);
+				entry->classification = &classification;
+			}
+
+			if (context->authenticode) {
+				stats_phase_begin(PhaseAuthenticode);
+				digest_boot_image(context, entry, imagep,
+						  &authenticode);
+				stats_phase_end(PhaseAuthenticode);
+				entry->authenticode = &authenticode;
+			}
+
+			if (context->bootInfo &&
+					entry->BootMediaType == NoEmulation) {
+				stats_phase_begin(PhaseBootInfo);
+				if (!check_boot_info(context, entry, imagep,
+						     &boot_info))
+					boot_info.present = 0;
+				stats_phase_end(PhaseBootInfo);
+				entry->boot_info = &boot_info;
+			}
+
+			/* only -d puts images in the text and XML output */
+			for_each_renderer(context, r)
+				call_renderer(r, entry, context, header, entry,
+					      context->dumpDiskImage ||
+					      r->ops->wants_images ?
+					      imagep : NULL);
+
+			/* with a stream, there may be a while to wait for
+			 * the next image */
+			if (input_stream)
+				for_each_renderer(context, r)
+					fflush(r->out);
+
+			entry->classification = NULL;
+			entry->authenticode = NULL;
+			entry->boot_info = NULL;
+			if (entry->stored) {
+				free(object.path);
+				entry->stored = NULL;
+			}
+			if (imagep) {
+				if (!image.shared)
+					free(image.data);
+				free(image.filename);
+			}
+		}
+
+		for_each_renderer(context, r)
+			call_renderer(r, end_header, context, header);
+	}
+
+	free_extraction(&extraction);
+	if (store && store_close(store) < 0)
+		return -1;
+	return incomplete ? 3 : 0;
+}
+
+int finish_renderers(struct context *context)
+{
+	struct renderer *r;
+	int ret = 0;
+
+	while ((r = context->renderers) != NULL) {
+		int rc = 0;
+
+		context->renderers = r->next;
+		stats_phase_begin(r->ops->phase);
+		if (r->ops->end)
+			rc = r->ops->end(r, context);
+		stats_phase_end(r->ops->phase);
+		if (rc < 0) {
+			fprintf(stderr, "dumpet: Error writing %s output: %m\n",
+				r->ops->name);
+			ret = rc;
+		}
+		if (r->ops->free)
+			r->ops->free(r);
+		if (r->out != stdout)
+			fclose(r->out);
+		free(r->path);
+		free(r);
+	}
+	return ret;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
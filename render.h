@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdio.h>
+
+#include "catalog.h"
+#include "stats.h"
+
+struct context;
+struct renderer;
+struct descriptor_set;
+
+/* A boot image as read for --dumpdisks.  Each image is read once and
+ * handed to every renderer. */
+struct boot_image {
+	Sector *data;
+	uint32_t sectors;	/* the whole file, or what the catalog asks for */
+	uint32_t nread;		/* what we actually got */
+	uint32_t payload;	/* bytes, without trailing zero padding */
+	char *filename;		/* set if it was also written to a file */
+	int shared;		/* data belongs to the extraction, not us */
+};
+
+struct renderer_ops {
+	const char *name;
+	Phase phase;		/* what --stats charges this renderer to */
+	int dumps_files;	/* wants --dumpdisks written to image.N */
+	int wants_images;	/* needs the boot images even without -d */
+
+	int (*load)(void);	/* pulls in what the renderer needs, or NULL */
+
+	int (*begin)(struct renderer *r, struct context *context,
+		     struct boot_catalog *cat);
+	void (*volume)(struct renderer *r, struct context *context,
+		       struct descriptor_set *set);
+	void (*header)(struct renderer *r, struct context *context,
+		       struct boot_header *header);
+	void (*entry)(struct renderer *r, struct context *context,
+		      struct boot_header *header, struct boot_entry *entry,
+		      struct boot_image *image);
+	void (*end_header)(struct renderer *r, struct context *context,
+			   struct boot_header *header);
+	int (*end)(struct renderer *r, struct context *context);
+	void (*free)(struct renderer *r);
+};
+
+struct renderer {
+	const struct renderer_ops *ops;
+	FILE *out;
+	char *path;
+	void *priv;
+	struct renderer *next;
+};
+
+extern const struct renderer_ops text_renderer_ops;
+extern const struct renderer_ops xml_renderer_ops;
+extern const struct renderer_ops tar_renderer_ops;
+extern const struct renderer_ops cpio_renderer_ops;
+extern const struct renderer_ops fingerprint_renderer_ops;
+extern const struct renderer_ops fingerprint_images_renderer_ops;
+
+extern int add_renderer(struct context *context, const char *spec);
+extern int write_boot_image(FILE *file, struct boot_image *image);
+extern int copy_image_range(FILE *iso, uint64_t offset, uint64_t length,
+			    FILE *out, uint64_t *copied);
+extern int render_catalog(struct context *context, struct boot_catalog *cat);
+extern int finish_renderers(struct context *context);
+
+#endif /* RENDER_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+
+#include "dumpet.h"
+#include "render.h"
+
+/* Archive outputs: every boot image becomes a member as soon as it has
+ * been read, and a text summary of the catalog is appended at the end, so
+ * nothing is written next to the input and nothing is read twice. */
+
+typedef enum {
+	ArchiveTar,
+	ArchiveCpio,
+} ArchiveFormat;
+
+struct archive_renderer {
+	ArchiveFormat format;
+	time_t mtime;
+	uint32_t ino;
+	struct renderer summary;	/* a text renderer writing to memory */
+	char *summary_buf;
+	size_t summary_len;
+};
+
+static const char zeros[512];
+
+static void write_padding(FILE *out, size_t len, size_t align)
+{
+	if (len % align)
+		fwrite(zeros, 1, align - len % align, out);
+}
+
+/* POSIX.1-1988 ustar */
+static void tar_member(FILE *out, const char *name, mode_t mode,
+		       time_t mtime, const void *data, size_t size)
+{
+	unsigned char hdr[512];
+	unsigned int sum = 0;
+	int i;
+
+	memset(hdr, '\0', sizeof(hdr));
+	snprintf((char *)hdr, 100, "%s", name);
+	snprintf((char *)hdr + 100, 8, "%07o", mode & 07777);
+	snprintf((char *)hdr + 108, 8, "%07o", 0);
+	snprintf((char *)hdr + 116, 8, "%07o", 0);
+	snprintf((char *)hdr + 124, 12, "%011llo", (unsigned long long)size);
+	snprintf((char *)hdr + 136, 12, "%011llo",
+		 (unsigned long long)mtime);
+	hdr[156] = '0';
+	memcpy(hdr + 257, "ustar", 6);
+	memcpy(hdr + 263, "00", 2);
+	snprintf((char *)hdr + 265, 32, "root");
+	snprintf((char *)hdr + 297, 32, "root");
+
+	memset(hdr + 148, ' ', 8);
+	for (i = 0; i < sizeof(hdr); i++)
+		sum += hdr[i];
+	snprintf((char *)hdr + 148, 8, "%06o", sum);
+
+	fwrite(hdr, 1, sizeof(hdr), out);
+	if (size)
+		fwrite(data, 1, size, out);
+	write_padding(out, size, 512);
+}
+
+/* SVR4 "newc" */
+static void cpio_member(FILE *out, uint32_t ino, const char *name,
+			mode_t mode, time_t mtime, const void *data,
+			size_t size)
+{
+	size_t namesize = strlen(name) + 1;
+	int len;
+
+	len = fprintf(out, "070701%08x%08x%08x%08x%08x%08x%08x"
+		      "%08x%08x%08x%08x%08zx%08x",
+		      ino, mode, 0, 0, 1, (uint32_t)mtime, (uint32_t)size,
+		      0, 0, 0, 0, namesize, 0);
+	fwrite(name, 1, namesize, out);
+	write_padding(out, len + namesize, 4);
+	if (size)
+		fwrite(data, 1, size, out);
+	write_padding(out, size, 4);
+}
+
+static void add_member(struct renderer *r, const char *name, const void *data,
+		       size_t size)
+{
+	struct archive_renderer *a = r->priv;
+
+	if (a->format == ArchiveTar)
+		tar_member(r->out, name, S_IFREG | 0644, a->mtime, data, size);
+	else
+		cpio_member(r->out, ++a->ino, name, S_IFREG | 0644, a->mtime,
+			    data, size);
+}
+
+/* The summary is what the text output would have said, minus hex dumps,
+ * which need a real file descriptor. */
+static struct context *summary_context(struct context *context,
+				       struct context *copy)
+{
+	*copy = *context;
+	copy->dumpHex = 0;
+	return copy;
+}
+
+static int archive_begin(struct renderer *r, struct context *context,
+			 struct boot_catalog *cat, ArchiveFormat format)
+{
+	struct archive_renderer *a;
+	struct context quiet;
+	struct stat sb;
+
+	a = calloc(1, sizeof(*a));
+	if (!a) {
+		fprintf(stderr, "dumpet: %m\n");
+		return -1;
+	}
+	r->priv = a;
+	a->format = format;
+
+	/* members get the input's mtime, so the archive is reproducible */
+	if (fstat(fileno(context->iso), &sb) == 0)
+		a->mtime = sb.st_mtime;
+
+	a->summary.ops = &text_renderer_ops;
+	a->summary.out = open_memstream(&a->summary_buf, &a->summary_len);
+	if (!a->summary.out) {
+		fprintf(stderr, "dumpet: %m\n");
+		return -1;
+	}
+	return text_renderer_ops.begin(&a->summary,
+				       summary_context(context, &quiet), cat);
+}
+
+static int tar_begin(struct renderer *r, struct context *context,
+		     struct boot_catalog *cat)
+{
+	return archive_begin(r, context, cat, ArchiveTar);
+}
+
+static int cpio_begin(struct renderer *r, struct context *context,
+		      struct boot_catalog *cat)
+{
+	return archive_begin(r, context, cat, ArchiveCpio);
+}
+
+static void archive_volume(struct renderer *r, struct context *context,
+			   struct descriptor_set *set)
+{
+	struct archive_renderer *a = r->priv;
+	struct context quiet;
+
+	text_renderer_ops.volume(&a->summary,
+				 summary_context(context, &quiet), set);
+}
+
+static void archive_header(struct renderer *r, struct context *context,
+			   struct boot_header *header)
+{
+	struct archive_renderer *a = r->priv;
+	struct context quiet;
+
+	text_renderer_ops.header(&a->summary,
+				 summary_context(context, &quiet), header);
+}
+
+static void archive_entry(struct renderer *r, struct context *context,
+			  struct boot_header *header, struct boot_entry *entry,
+			  struct boot_image *image)
+{
+	struct archive_renderer *a = r->priv;
+	struct context quiet;
+	char platform[16];
+	char name[32];
+	int i;
+
+	text_renderer_ops.entry(&a->summary, summary_context(context, &quiet),
+				header, entry, NULL);
+	if (!image)
+		return;
+
+	/* e.g. "0-80x86.img", "1-efi.img" */
+	snprintPlatformId(platform, sizeof(platform), entry->PlatformId);
+	for (i = 0; platform[i]; i++) {
+		if (isalnum(platform[i]))
+			platform[i] = tolower(platform[i]);
+		else
+			platform[i] = '_';
+	}
+	snprintf(name, sizeof(name), "%d-%s.img", entry->filenum, platform);
+	add_member(r, name, image->data, image->nread * sizeof(Sector));
+}
+
+static int archive_end(struct renderer *r, struct context *context)
+{
+	struct archive_renderer *a = r->priv;
+
+	if (!a || !a->summary.out)
+		return -1;
+
+	fclose(a->summary.out);
+	a->summary.out = NULL;
+	add_member(r, "catalog.txt", a->summary_buf, a->summary_len);
+
+	if (a->format == ArchiveTar) {
+		fwrite(zeros, 1, sizeof(zeros), r->out);
+		fwrite(zeros, 1, sizeof(zeros), r->out);
+	} else {
+		cpio_member(r->out, 0, "TRAILER!!!", 0, 0, NULL, 0);
+	}
+
+	return fflush(r->out) || ferror(r->out) ? -1 : 0;
+}
+
+static void archive_free(struct renderer *r)
+{
+	struct archive_renderer *a = r->priv;
+
+	if (!a)
+		return;
+	if (a->summary.out)
+		fclose(a->summary.out);
+	free(a->summary_buf);
+	free(a);
+}
+
+const struct renderer_ops tar_renderer_ops = {
+	.name = "tar",
+	.phase = PhaseArchive,
+	.wants_images = 1,
+	.begin = tar_begin,
+	.volume = archive_volume,
+	.header = archive_header,
+	.entry = archive_entry,
+	.end = archive_end,
+	.free = archive_free,
+};
+
+const struct renderer_ops cpio_renderer_ops = {
+	.name = "cpio",
+	.phase = PhaseArchive,
+	.wants_images = 1,
+	.begin = cpio_begin,
+	.volume = archive_volume,
+	.header = archive_header,
+	.entry = archive_entry,
+	.end = archive_end,
+	.free = archive_free,
+};
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dumpet.h"
+#include "render.h"
+#include "sha256.h"
+
+/* A 128-bit fingerprint of the boot configuration, for grouping images
+ * that boot the same way without comparing whole dumps: the first half
+ * of a SHA-256 over a canonical encoding of the decoded catalog.  Load
+ * LBAs are taken relative to the lowest one in the catalog, so where the
+ * mastering tool happened to put the images doesn't matter, and the
+ * validation entry's checksum is left out since it only follows from the
+ * rest.  fingerprint-images also takes in each boot image's SHA-256, the
+ * same digest --store names it by. */
+
+#define FINGERPRINT_SIZE 16
+
+struct fingerprint_renderer {
+	struct sha256_ctx ctx;
+	uint32_t base;
+	int valid;
+};
+
+static void put(struct fingerprint_renderer *f, const void *data, size_t len)
+{
+	sha256_update(&f->ctx, data, len);
+}
+
+static void put8(struct fingerprint_renderer *f, uint8_t v)
+{
+	put(f, &v, 1);
+}
+
+static void put16(struct fingerprint_renderer *f, uint16_t v)
+{
+	uint8_t b[2] = { v & 0xff, v >> 8 };
+
+	put(f, b, sizeof(b));
+}
+
+static void put32(struct fingerprint_renderer *f, uint32_t v)
+{
+	uint8_t b[4] = { v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff,
+			 v >> 24 };
+
+	put(f, b, sizeof(b));
+}
+
+static int fingerprint_begin(struct renderer *r, struct context *context,
+			     struct boot_catalog *cat)
+{
+	struct fingerprint_renderer *f;
+	int i;
+
+	f = calloc(1, sizeof(*f));
+	if (!f) {
+		fprintf(stderr, "dumpet: %m\n");
+		return -1;
+	}
+	r->priv = f;
+	f->valid = cat->checksum_ok;
+
+	f->base = UINT32_MAX;
+	for (i = 0; i < cat->nentries; i++)
+		if (cat->entries[i].LoadLBA < f->base)
+			f->base = cat->entries[i].LoadLBA;
+
+	/* the two kinds of fingerprint must never be equal */
+	sha256_init(&f->ctx);
+	put(f, r->ops->name, strlen(r->ops->name) + 1);
+	put8(f, 1);	/* encoding version */
+	return 0;
+}
+
+static void fingerprint_header(struct renderer *r, struct context *context,
+			       struct boot_header *header)
+{
+	struct fingerprint_renderer *f = r->priv;
+	char id[sizeof(header->Id) - 1];
+
+	memset(id, '\0', sizeof(id));
+	memcpy(id, header->Id, strnlen(header->Id, sizeof(id)));
+	put8(f, 'H');
+	put8(f, header->HeaderIndicator);
+	put8(f, header->PlatformId);
+	put(f, id, sizeof(id));
+	put16(f, header->SectionEntryCount);
+}
+
+static void fingerprint_entry(struct renderer *r, struct context *context,
+			      struct boot_header *header,
+			      struct boot_entry *entry,
+			      struct boot_image *image)
+{
+	struct fingerprint_renderer *f = r->priv;
+	uint8_t digest[SHA256_DIGEST_SIZE];
+
+	put8(f, 'E');
+	put8(f, entry->BootIndicator);
+	put8(f, entry->BootMediaType);
+	put16(f, entry->LoadSegment);
+	put8(f, entry->SystemType);
+	put16(f, entry->SectorCount);
+	put32(f, entry->LoadLBA - f->base);
+	put8(f, entry->SelectionCriteriaType);
+
+	if (!r->ops->wants_images)
+		return;
+	memset(digest, '\0', sizeof(digest));
+	if (image && image->nread) {
+		struct sha256_ctx ctx;
+
+		sha256_init(&ctx);
+		sha256_update(&ctx, image->data,
+			      (uint64_t)image->nread * sizeof(Sector));
+		sha256_final(&ctx, digest);
+	}
+	put(f, digest, sizeof(digest));
+}
+
+static int fingerprint_end(struct renderer *r, struct context *context)
+{
+	struct fingerprint_renderer *f = r->priv;
+	uint8_t digest[SHA256_DIGEST_SIZE];
+	int i;
+
+	/* nothing was walked if the catalog is no good */
+	if (!f || !f->valid)
+		return 0;
+
+	sha256_final(&f->ctx, digest);
+	for (i = 0; i < FINGERPRINT_SIZE; i++)
+		fprintf(r->out, "%02x", digest[i]);
+	fprintf(r->out, "  %s\n", context->filename);
+	return fflush(r->out) ? -1 : 0;
+}
+
+static void fingerprint_free(struct renderer *r)
+{
+	free(r->priv);
+	r->priv = NULL;
+}
+
+const struct renderer_ops fingerprint_renderer_ops = {
+	.name = "fingerprint",
+	.phase = PhaseFingerprint,
+	.begin = fingerprint_begin,
+	.header = fingerprint_header,
+	.entry = fingerprint_entry,
+	.end = fingerprint_end,
+	.free = fingerprint_free,
+};
+
+const struct renderer_ops fingerprint_images_renderer_ops = {
+	.name = "fingerprint-images",
+	.phase = PhaseFingerprint,
+	.wants_images = 1,
+	.begin = fingerprint_begin,
+	.header = fingerprint_header,
+	.entry = fingerprint_entry,
+	.end = fingerprint_end,
+	.free = fingerprint_free,
+};
+
+/* vim:set shiftwidth=8 softtabstop=8: */
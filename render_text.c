@@ -0,0 +1,296 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "dumpet.h"
+#include "hexdump.h"
+#include "render.h"
+#include "volume.h"
+#include "classify.h"
+#include "bootinfo.h"
+#include "pe.h"
+#include "store.h"
+
+static void dumpHex(FILE *out, void *data, ssize_t length)
+{
+	fflush(out);
+	hexdump_fd(fileno(out), data, length, 0);
+}
+
+static int text_begin(struct renderer *r, struct context *context,
+		      struct boot_catalog *cat)
+{
+	if (!cat->checksum_ok)
+		fprintf(r->out, "Validation Entry Checksum is incorrect\n");
+	return 0;
+}
+
+static void text_volume(struct renderer *r, struct context *context,
+			struct descriptor_set *set)
+{
+	FILE *out = r->out;
+	struct iso_volume *vol = &set->primary;
+	int i;
+
+	fprintf(out, "Volume Descriptor Set:\n");
+	for (i = 0; i < set->ndescriptors; i++) {
+		struct volume_descriptor *vd = &set->descriptors[i];
+
+		fprintf(out, "\tSector %u: %s (%s", vd->lba,
+			descriptor_name(vd), vd->Id);
+		if (!strcmp(vd->Id, "CD001")) {
+			switch (vd->Type) {
+				case BootRecordDescriptor:
+					fprintf(out, ", \"%s\"", vd->SystemId);
+					break;
+				case SupplementaryDescriptor:
+					if (vd->JolietLevel)
+						fprintf(out, ", Joliet level %d",
+							vd->JolietLevel);
+					break;
+				case PartitionDescriptor:
+					fprintf(out, ", \"%s\", sectors %u-%u",
+						vd->VolumeId, vd->Extent,
+						vd->Extent + vd->Size - 1);
+					break;
+			}
+		}
+		fprintf(out, ")\n");
+	}
+	if (!set->terminated)
+		fprintf(out, "\tNo Volume Descriptor Set Terminator\n");
+
+	if (!vol->has_pvd)
+		return;
+	fprintf(out, "Primary Volume Descriptor:\n");
+	fprintf(out, "\tSystem ID: \"%s\"\n", vol->SystemId);
+	fprintf(out, "\tVolume ID: \"%s\"\n", vol->VolumeId);
+	fprintf(out, "\tVolume Space Size: %u\n", vol->VolumeSpaceSize);
+	fprintf(out, "\tLogical Block Size: %u\n", vol->LogicalBlockSize);
+	fprintf(out, "\tRoot Directory: sector %u, %u bytes\n",
+		vol->RootExtent, vol->RootSize);
+}
+
+static void text_header(struct renderer *r, struct context *context,
+			struct boot_header *header)
+{
+	FILE *out = r->out;
+	char platformbuf[16];
+
+	snprintPlatformId(platformbuf, 15, header->PlatformId);
+
+	switch (header->HeaderIndicator) {
+		case ValidationIndicator:
+			fprintf(out, "Validation Entry:\n");
+
+			if (context->dumpHex)
+				dumpHex(out, header->raw, sizeof(*header->raw));
+
+			fprintf(out, "\tHeader Indicator: 0x%02x (Validation Entry)\n",
+				header->HeaderIndicator);
+			fprintf(out, "\tPlatformId: 0x%02x (%s)\n",
+				header->PlatformId, platformbuf);
+			fprintf(out, "\tID: \"%s\"\n", header->Id);
+			fprintf(out, "\tChecksum: 0x%04x\n", header->Checksum);
+			fprintf(out, "\tKey bytes: 0x%02x%02x\n",
+				header->KeyBytes[0], header->KeyBytes[1]);
+			break;
+		case SectionHeaderIndicator:
+		case FinalSectionHeaderIndicator:
+			fprintf(out, "Section Header Entry:\n");
+
+			if (context->dumpHex)
+				dumpHex(out, header->raw, sizeof(*header->raw));
+
+			fprintf(out, "\tHeader Indicator: 0x%02x ",
+				header->HeaderIndicator);
+			if (header->HeaderIndicator == SectionHeaderIndicator)
+				fprintf(out, "(Section Header Entry)\n");
+			else
+				fprintf(out, "(Final Section Header Entry)\n");
+
+			fprintf(out, "\tPlatformId: 0x%02x (%s)\n",
+				header->PlatformId, platformbuf);
+			fprintf(out, "\tSection Entries: %d\n",
+				header->SectionEntryCount);
+			fprintf(out, "\tID: \"%s\"\n", header->Id);
+			break;
+		default:
+			fprintf(stderr,
+				"Invalid Header Indicator (0x%04x), skipping\n",
+				header->HeaderIndicator);
+			break;
+	}
+}
+
+static void text_entry(struct renderer *r, struct context *context,
+		       struct boot_header *header, struct boot_entry *entry,
+		       struct boot_image *image)
+{
+	FILE *out = r->out;
+	int is_default = header->HeaderIndicator == ValidationIndicator;
+	uint16_t loadseg = entry->LoadSegment;
+	char bmtype[64];
+
+	snprintBootMediaType(bmtype, 63, entry->BootMediaType);
+
+	if (is_default)
+		fprintf(out, "Boot Catalog Default Entry:\n");
+	else
+		fprintf(out, "Boot Catalog Section Entry:\n");
+
+	if (context->dumpHex)
+		dumpHex(out, entry->raw, sizeof(*entry->raw));
+
+	switch (entry->BootIndicator) {
+		case NotBootable:
+			fprintf(out, "\tEntry is not bootable\n");
+			break;
+		case Bootable:
+			fprintf(out, "\tEntry is bootable\n");
+			break;
+		default:
+			fprintf(out, "\tInvalid boot indicator\n");
+			break;
+	}
+
+	fprintf(out, "\tBoot Media emulation type: %s\n", bmtype);
+
+	switch (entry->PlatformId) {
+		case x86:
+			if (!is_default) {
+				fprintf(out, "\tMedia load segment: 0x%04x\n",
+					loadseg == 0 ? 0x7c0 : loadseg);
+			} else if (loadseg == 0) {
+				fprintf(out, "\tMedia load segment: 0x0 (0000:7c00)\n");
+			} else {
+				fprintf(out, "\tMedia load segment: 0x%04x (%04x:0000)\n",
+					loadseg, loadseg);
+			}
+			break;
+		case ppc:
+		case m68kmac:
+		case efi:
+			fprintf(out, "\tMedia load address: %d (0x%04x)\n",
+				loadseg * 0x10, loadseg * 0x10);
+			break;
+		default:
+			fprintf(out, "\tMedia load address: %d (0x%04x) (raw value)\n",
+				loadseg, loadseg);
+			break;
+	}
+
+	fprintf(out, "\tSystem type: %d (0x%02x)\n", entry->SystemType,
+		entry->SystemType);
+	fprintf(out, "\tLoad Sectors: %d (0x%04x)\n", entry->SectorCount,
+		entry->SectorCount);
+	fprintf(out, "\tLoad LBA: %d (0x%08x)\n", entry->LoadLBA,
+		entry->LoadLBA);
+
+	if (entry->classification) {
+		struct classification *cl = entry->classification;
+		int i;
+
+		fprintf(out, "\tImage type: %s\n", cl->type);
+		for (i = 0; i < cl->ncontents; i++) {
+			fprintf(out, "\tContains: %s", cl->contents[i].name);
+			if (cl->contents[i].version[0])
+				fprintf(out, " %s", cl->contents[i].version);
+			fprintf(out, "\n");
+		}
+		for (i = 0; i < cl->nmatches; i++)
+			fprintf(out, "\tMatch: \"%s\" at 0x%"PRIx64"\n",
+				cl->matches[i].pattern, cl->matches[i].offset);
+	}
+
+	if (entry->authenticode) {
+		struct authenticode *ac = entry->authenticode;
+		int i, j;
+
+		if (ac->ndigests == 0)
+			fprintf(out, "\tAuthenticode: no PE binaries\n");
+		for (i = 0; i < ac->ndigests; i++) {
+			struct authenticode_digest *d = &ac->digests[i];
+
+			fprintf(out, "\tAuthenticode SHA-256: ");
+			for (j = 0; j < sizeof(d->digest); j++)
+				fprintf(out, "%02x", d->digest[j]);
+			if (d->path[0])
+				fprintf(out, " %s", d->path);
+			fprintf(out, " (%s)\n", pe_machine_name(d->machine));
+		}
+	}
+
+	if (entry->boot_info) {
+		struct boot_info *bi = entry->boot_info;
+		int i, n = 0;
+
+		if (!bi->present)
+			fprintf(out, "\tBoot info table: none\n");
+		else
+			fprintf(out, "\tBoot info table: PVD LBA %u, file LBA %u, "
+				"length %u, checksum 0x%08x\n", bi->PvdLBA,
+				bi->FileLBA, bi->FileLength, bi->Checksum);
+		if (bi->present && !bi->problems)
+			fprintf(out, "\tBoot info table is correct\n");
+		for (i = 0; bi->present && i < BOOT_INFO_NPROBLEMS; i++) {
+			if (!(bi->problems & (1 << i)))
+				continue;
+			fprintf(out, "%s%s", n++ ? ", " :
+				"\tBoot info table is stale: ",
+				boot_info_problem(i));
+		}
+		if (n && (bi->problems & BOOT_INFO_BAD_CHECKSUM))
+			fprintf(out, " (now 0x%08x)", bi->computed);
+		if (n)
+			fprintf(out, "\n");
+	}
+
+	if (entry->stored)
+		fprintf(out, "\tStored as %s (%s)\n", entry->stored->digest,
+			entry->stored->new ? "new" : "already stored");
+
+	if (image && image->filename) {
+		fprintf(out, "Dumping boot image to \"%s\"\n", image->filename);
+		fprintf(out, "\tPayload length: %u bytes\n", image->payload);
+	}
+}
+
+static int text_end(struct renderer *r, struct context *context)
+{
+	return fflush(r->out) ? -1 : 0;
+}
+
+const struct renderer_ops text_renderer_ops = {
+	.name = "text",
+	.phase = PhaseText,
+	.dumps_files = 1,
+	.begin = text_begin,
+	.volume = text_volume,
+	.header = text_header,
+	.entry = text_entry,
+	.end = text_end,
+};
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,543 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "dumpet.h"
+#include "render.h"
+#include "volume.h"
+#include "classify.h"
+#include "bootinfo.h"
+#include "pe.h"
+#include "simd.h"
+#include "store.h"
+#include "xmlload.h"
+
+struct xml_renderer {
+	FILE *out;
+	int error;		/* a write to out failed */
+	char *held;		/* what went to out, if out is a memstream */
+	size_t nheld;
+	xmlTextWriterPtr writer;
+};
+
+static int shares_output(struct context *context, struct renderer *r)
+{
+	struct renderer *other;
+
+	for (other = context->renderers; other; other = other->next)
+		if (other != r && other->out == r->out)
+			return 1;
+	return 0;
+}
+
+/* libxml2 hands over its output a buffer at a time as the document is
+ * built, rather than all of it at the end. */
+static int xml_write(void *context, const char *buf, int len)
+{
+	struct xml_renderer *x = context;
+
+	if (fwrite(buf, 1, len, x->out) != (size_t)len) {
+		x->error = 1;
+		return -1;
+	}
+	stats_xml_written(len);
+	return len;
+}
+
+static int xml_begin(struct renderer *r, struct context *context,
+		     struct boot_catalog *cat)
+{
+	struct xml_renderer *x;
+	xmlOutputBufferPtr out;
+	int rc;
+
+	x = calloc(1, sizeof(*x));
+	if (!x) {
+		fprintf(stderr, "Error creating XML buffer: %m\n");
+		return -1;
+	}
+	r->priv = x;
+	x->out = r->out;
+	/* Another output writes to the same file as it goes, so the
+	 * document is held back and written after it, not mixed into it. */
+	if (shares_output(context, r)) {
+		x->out = open_memstream(&x->held, &x->nheld);
+		if (!x->out) {
+			fprintf(stderr, "Error creating XML buffer: %m\n");
+			return -1;
+		}
+	}
+
+	out = xmlOutputBufferCreateIO(xml_write, NULL, x, NULL);
+	if (!out) {
+		fprintf(stderr, "Error creating XML buffer: %m\n");
+		return -1;
+	}
+	/* the writer owns out from here on */
+	x->writer = xmlNewTextWriter(out);
+	if (!x->writer) {
+		xmlOutputBufferClose(out);
+		fprintf(stderr, "Error creating XML writer\n");
+		return -1;
+	}
+	rc = xmlTextWriterStartDocument(x->writer, NULL, "UTF-8", NULL);
+	if (rc < 0) {
+		fprintf(stderr, "Error starting new XML document\n");
+		return -1;
+	}
+	rc = xmlTextWriterStartElement(x->writer, BAD_CAST "ElToritoBootCatalog");
+	if (rc < 0) {
+		fprintf(stderr, "Error creating element \"El-Torito\"\n");
+		return -1;
+	}
+	return 0;
+}
+
+static void xml_volume(struct renderer *r, struct context *context,
+		       struct descriptor_set *set)
+{
+	struct xml_renderer *x = r->priv;
+	xmlTextWriterPtr writer = x->writer;
+	struct iso_volume *vol = &set->primary;
+	int i;
+
+	xmlTextWriterStartElement(writer, BAD_CAST "VolumeDescriptorSet");
+	xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "Terminated",
+				"%s", set->terminated ? "True" : "False");
+
+	for (i = 0; i < set->ndescriptors; i++) {
+		struct volume_descriptor *vd = &set->descriptors[i];
+
+		xmlTextWriterStartElement(writer, BAD_CAST "VolumeDescriptor");
+		xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "Sector",
+						  "%u", vd->lba);
+		xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "Identifier", "%s", vd->Id);
+		if (!strcmp(vd->Id, "CD001"))
+			xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "Type", "%u", vd->Type);
+		xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "Version",
+						  "%u", vd->Version);
+		if (vd->JolietLevel)
+			xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "JolietLevel", "%d",
+					vd->JolietLevel);
+		if (!strcmp(vd->Id, "CD001") &&
+				vd->Type == BootRecordDescriptor)
+			xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "BootSystemId", "%s",
+					vd->SystemId);
+		if (!strcmp(vd->Id, "CD001") &&
+				vd->Type == PartitionDescriptor) {
+			xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "PartitionId", "%s",
+					vd->VolumeId);
+			xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "Extent", "%u", vd->Extent);
+			xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "Size", "%u", vd->Size);
+		}
+		xmlTextWriterWriteString(writer,
+					 BAD_CAST descriptor_name(vd));
+		xmlTextWriterEndElement(writer);
+	}
+
+	if (vol->has_pvd) {
+		xmlTextWriterStartElement(writer,
+					  BAD_CAST "PrimaryVolumeDescriptor");
+		xmlTextWriterWriteFormatElement(writer, BAD_CAST "SystemId",
+						"%s", vol->SystemId);
+		xmlTextWriterWriteFormatElement(writer, BAD_CAST "VolumeId",
+						"%s", vol->VolumeId);
+		xmlTextWriterWriteFormatElement(writer,
+				BAD_CAST "VolumeSpaceSize", "%u",
+				vol->VolumeSpaceSize);
+		xmlTextWriterWriteFormatElement(writer,
+				BAD_CAST "LogicalBlockSize", "%u",
+				vol->LogicalBlockSize);
+		xmlTextWriterStartElement(writer, BAD_CAST "RootDirectory");
+		xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "Sector",
+						  "%u", vol->RootExtent);
+		xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "Size",
+						  "%u", vol->RootSize);
+		xmlTextWriterEndElement(writer);
+		xmlTextWriterEndElement(writer);
+	}
+
+	xmlTextWriterEndElement(writer);
+}
+
+static void xml_platform_id(xmlTextWriterPtr writer, uint8_t platformId)
+{
+	char platformbuf[16];
+
+	snprintPlatformId(platformbuf, 15, platformId);
+
+	xmlTextWriterStartElement(writer, BAD_CAST "PlatformId");
+	xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "RawValue", "0x%02x", platformId);
+	xmlTextWriterStartAttribute(writer, BAD_CAST "Value");
+	xmlTextWriterWriteString(writer, BAD_CAST platformbuf);
+	xmlTextWriterEndAttribute(writer);
+	xmlTextWriterEndElement(writer);
+}
+
+static void xml_header(struct renderer *r, struct context *context,
+		       struct boot_header *header)
+{
+	struct xml_renderer *x = r->priv;
+	xmlTextWriterPtr writer = x->writer;
+
+	switch (header->HeaderIndicator) {
+		case ValidationIndicator:
+			xmlTextWriterStartElement(writer,
+				BAD_CAST "BootCatalogValidationEntry");
+
+			xml_platform_id(writer, header->PlatformId);
+
+			xmlTextWriterWriteFormatElement(writer,
+				BAD_CAST "IdString", "%s", header->Id);
+
+			xmlTextWriterWriteFormatElement(writer,
+				BAD_CAST "Checksum", "%04x", header->Checksum);
+
+			xmlTextWriterWriteFormatElement(writer,
+				BAD_CAST "KeyBytes", "%02x%02x",
+				header->KeyBytes[0], header->KeyBytes[1]);
+			break;
+		case SectionHeaderIndicator:
+		case FinalSectionHeaderIndicator:
+			xmlTextWriterStartElement(writer,
+				BAD_CAST "BootCatalogSectionHeaderEntry");
+
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "FinalSectionHeaderEntry", "%s",
+				(header->HeaderIndicator == FinalSectionHeaderIndicator ?
+					  "True":"False"));
+
+			xml_platform_id(writer, header->PlatformId);
+
+			xmlTextWriterWriteFormatElement(writer,
+				BAD_CAST "IdString", "%s", header->Id);
+
+			xmlTextWriterWriteFormatElement(writer,
+				BAD_CAST "SectionEntryCount", "%d",
+				header->SectionEntryCount);
+			break;
+	}
+}
+
+static void xml_classification(xmlTextWriterPtr writer,
+			       struct classification *cl)
+{
+	int i;
+
+	xmlTextWriterStartElement(writer, BAD_CAST "Classification");
+	xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "Type", "%s",
+					  cl->type);
+	for (i = 0; i < cl->ncontents; i++) {
+		xmlTextWriterStartElement(writer, BAD_CAST "Contains");
+		if (cl->contents[i].version[0])
+			xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "Version", "%s",
+					cl->contents[i].version);
+		xmlTextWriterWriteString(writer,
+					 BAD_CAST cl->contents[i].name);
+		xmlTextWriterEndElement(writer);
+	}
+	for (i = 0; i < cl->nmatches; i++) {
+		xmlTextWriterStartElement(writer, BAD_CAST "Match");
+		xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "Offset",
+				"0x%"PRIx64, cl->matches[i].offset);
+		xmlTextWriterWriteString(writer,
+					 BAD_CAST cl->matches[i].pattern);
+		xmlTextWriterEndElement(writer);
+	}
+	xmlTextWriterEndElement(writer);
+}
+
+static void xml_boot_info(xmlTextWriterPtr writer, struct boot_info *bi)
+{
+	int i;
+
+	xmlTextWriterStartElement(writer, BAD_CAST "BootInfoTable");
+	xmlTextWriterWriteAttribute(writer, BAD_CAST "Present",
+				    BAD_CAST (bi->present ? "True" : "False"));
+	if (bi->present) {
+		xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "PvdLBA",
+						  "0x%08x", bi->PvdLBA);
+		xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "FileLBA",
+						  "0x%08x", bi->FileLBA);
+		xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "FileLength", "%u", bi->FileLength);
+		xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "Checksum",
+						  "0x%08x", bi->Checksum);
+		xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "ComputedChecksum", "0x%08x",
+				bi->computed);
+		xmlTextWriterWriteAttribute(writer, BAD_CAST "Valid",
+				BAD_CAST (bi->problems ? "False" : "True"));
+	}
+	for (i = 0; bi->present && i < BOOT_INFO_NPROBLEMS; i++) {
+		if (!(bi->problems & (1 << i)))
+			continue;
+		xmlTextWriterWriteFormatElement(writer, BAD_CAST "Mismatch",
+						"%s", boot_info_problem(i));
+	}
+	xmlTextWriterEndElement(writer);
+}
+
+static void xml_authenticode(xmlTextWriterPtr writer, struct authenticode *ac)
+{
+	char hex[SHA256_DIGEST_SIZE * 2 + 1];
+	int i, j;
+
+	for (i = 0; i < ac->ndigests; i++) {
+		struct authenticode_digest *d = &ac->digests[i];
+
+		for (j = 0; j < sizeof(d->digest); j++)
+			sprintf(hex + j * 2, "%02x", d->digest[j]);
+
+		xmlTextWriterStartElement(writer, BAD_CAST "Authenticode");
+		xmlTextWriterWriteAttribute(writer, BAD_CAST "Algorithm",
+					    BAD_CAST "SHA-256");
+		if (d->path[0])
+			xmlTextWriterWriteAttribute(writer, BAD_CAST "Path",
+						    BAD_CAST d->path);
+		xmlTextWriterWriteAttribute(writer, BAD_CAST "Machine",
+				BAD_CAST pe_machine_name(d->machine));
+		xmlTextWriterWriteString(writer, BAD_CAST hex);
+		xmlTextWriterEndElement(writer);
+	}
+}
+
+/* base64 digits need no escaping, so they're encoded a chunk at a time
+ * and go into the document as they are. */
+static void xml_base64(xmlTextWriterPtr writer, const uint8_t *data,
+		       size_t len)
+{
+	const size_t chunk = 3 * 16384;
+	char *buf;
+
+	buf = malloc(BASE64_LENGTH(chunk));
+	if (!buf) {
+		fprintf(stderr, "dumpet: %m\n");
+		return;
+	}
+	while (len) {
+		size_t n = len < chunk ? len : chunk;
+
+		xmlTextWriterWriteRawLen(writer, BAD_CAST buf,
+					 base64_encode(data, n, buf));
+		data += n;
+		len -= n;
+	}
+	free(buf);
+}
+
+static void xml_boot_image(xmlTextWriterPtr writer, struct boot_entry *entry,
+			   struct boot_image *image, int base64)
+{
+	xmlTextWriterStartElement(writer, BAD_CAST "BootImage");
+	/* what the catalog describes, which needn't be the whole file */
+	xmlTextWriterWriteFormatAttribute(writer, BAD_CAST "HeaderSize",
+		"0x%x", boot_entry_sectors(entry) * 2048);
+	xmlTextWriterWriteFormatAttribute(writer,
+		BAD_CAST "ActualSize", "0x%x", image->nread * 2048);
+	xmlTextWriterWriteFormatAttribute(writer,
+		BAD_CAST "PayloadSize", "0x%x", image->payload);
+	if (base64) {
+		xmlTextWriterWriteAttribute(writer, BAD_CAST "Encoding",
+					    BAD_CAST "base64");
+		xml_base64(writer, (uint8_t *)image->data,
+			   image->nread * sizeof(Sector));
+	} else {
+		xmlTextWriterWriteBinHex(writer, (char *)image->data,
+			0, image->nread * sizeof(Sector));
+	}
+	xmlTextWriterEndElement(writer); /* end BootImage */
+}
+
+static void xml_entry(struct renderer *r, struct context *context,
+		      struct boot_header *header, struct boot_entry *entry,
+		      struct boot_image *image)
+{
+	struct xml_renderer *x = r->priv;
+	xmlTextWriterPtr writer = x->writer;
+	uint16_t loadseg = entry->LoadSegment;
+	char bmtype[64];
+
+	snprintBootMediaType(bmtype, 63, entry->BootMediaType);
+
+	if (header->HeaderIndicator == ValidationIndicator)
+		xmlTextWriterStartElement(writer,
+			BAD_CAST "BootCatalogDefaultEntry");
+	else
+		xmlTextWriterStartElement(writer,
+			BAD_CAST "BootCatalogSectionEntry");
+
+	xmlTextWriterWriteFormatElement(writer,
+		BAD_CAST "Bootable", "%s",
+		entry->BootIndicator ? "True" : "False");
+
+	xmlTextWriterWriteFormatElement(writer,
+		BAD_CAST "BootMediaEmulationType", "%s", bmtype);
+
+	xmlTextWriterStartElement(writer, BAD_CAST "MediaLoadSegment");
+	switch (entry->PlatformId) {
+		case x86:
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "RawValue", "0x%04x", loadseg);
+			if (loadseg == 0) {
+				xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "Value", "0000:7c00");
+			} else {
+				xmlTextWriterWriteFormatAttribute(writer,
+					BAD_CAST "Value", "%04x:0000", loadseg);
+			}
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "ValueType", "Interpreted");
+			break;
+		case ppc:
+		case m68kmac:
+		case efi:
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "RawValue", "0x%04x", loadseg);
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "Value", "0x%04x", loadseg * 0x10);
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "ValueType", "Interpreted");
+			break;
+		default:
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "RawValue", "0x%04x", loadseg);
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "Value", "0x%04x", loadseg);
+			xmlTextWriterWriteFormatAttribute(writer,
+				BAD_CAST "ValueType", "Raw");
+			break;
+	}
+	xmlTextWriterEndElement(writer); /* end MediaLoadSegment */
+
+	xmlTextWriterWriteFormatElement(writer,
+		BAD_CAST "SystemType", "0x%02x", entry->SystemType);
+
+	xmlTextWriterWriteFormatElement(writer,
+		BAD_CAST "LoadSectors", "0x%04x", entry->SectorCount);
+
+	xmlTextWriterWriteFormatElement(writer,
+		BAD_CAST "LoadLBA", "0x%08x", entry->LoadLBA);
+
+	if (entry->classification)
+		xml_classification(writer, entry->classification);
+
+	if (entry->authenticode)
+		xml_authenticode(writer, entry->authenticode);
+
+	if (entry->boot_info)
+		xml_boot_info(writer, entry->boot_info);
+
+	if (entry->stored) {
+		xmlTextWriterStartElement(writer, BAD_CAST "StoredImage");
+		xmlTextWriterWriteAttribute(writer, BAD_CAST "Algorithm",
+					    BAD_CAST "SHA-256");
+		xmlTextWriterWriteAttribute(writer, BAD_CAST "New",
+			BAD_CAST (entry->stored->new ? "True" : "False"));
+		xmlTextWriterWriteString(writer,
+					 BAD_CAST entry->stored->digest);
+		xmlTextWriterEndElement(writer);
+	}
+
+	if (image)
+		xml_boot_image(writer, entry, image, context->base64);
+
+	/* end BootCatalogDefaultEntry or BootCatalogSectionEntry */
+	xmlTextWriterEndElement(writer);
+}
+
+static void xml_end_header(struct renderer *r, struct context *context,
+			   struct boot_header *header)
+{
+	struct xml_renderer *x = r->priv;
+
+	/* Either A ValidationEntry or a SectionHeaderEntry is open here */
+	if (boot_header_valid(header))
+		xmlTextWriterEndElement(x->writer);
+}
+
+static int xml_end(struct renderer *r, struct context *context)
+{
+	struct xml_renderer *x = r->priv;
+	int rc;
+
+	if (!x || !x->writer)
+		return -1;
+
+	xmlTextWriterEndElement(x->writer);
+	xmlTextWriterEndDocument(x->writer);
+	/* this flushes whatever libxml2 still has buffered */
+	xmlFreeTextWriter(x->writer);
+	x->writer = NULL;
+
+	if (x->out != r->out) {
+		if (fclose(x->out) == EOF)
+			x->error = 1;
+		x->out = NULL;
+		if (!x->error && fwrite(x->held, 1, x->nheld, r->out) !=
+				x->nheld)
+			x->error = 1;
+	}
+	rc = fflush(r->out);
+	return x->error || rc == EOF ? -1 : 0;
+}
+
+static void xml_free(struct renderer *r)
+{
+	struct xml_renderer *x = r->priv;
+
+	if (!x)
+		return;
+	if (x->writer)
+		xmlFreeTextWriter(x->writer);
+	if (x->out && x->out != r->out)
+		fclose(x->out);
+	free(x->held);
+	free(x);
+	r->priv = NULL;
+}
+
+const struct renderer_ops xml_renderer_ops = {
+	.name = "xml",
+	.phase = PhaseXml,
+	.load = load_libxml,
+	.begin = xml_begin,
+	.volume = xml_volume,
+	.header = xml_header,
+	.entry = xml_entry,
+	.end_header = xml_end_header,
+	.end = xml_end,
+	.free = xml_free,
+};
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "dumpet.h"
+#include "catalog.h"
+#include "endian.h"
+#include "volume.h"
+
+static Sector *read_new_image(const char *path, uint32_t *size,
+			      uint32_t *sectors)
+{
+	struct stat sb;
+	Sector *data;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f) {
+		fprintf(stderr, "Could not open \"%s\": %m\n", path);
+		return NULL;
+	}
+	if (fstat(fileno(f), &sb) < 0 || !S_ISREG(sb.st_mode) ||
+			sb.st_size == 0 || sb.st_size > UINT32_MAX) {
+		fprintf(stderr, "dumpet: \"%s\" is not a usable boot image\n",
+			path);
+		fclose(f);
+		return NULL;
+	}
+	*size = sb.st_size;
+	*sectors = (*size + sizeof(Sector) - 1) / sizeof(Sector);
+
+	/* calloc, so the tail of the last sector is zero padded */
+	data = calloc(*sectors, sizeof(Sector));
+	if (!data || fread(data, 1, *size, f) != *size) {
+		fprintf(stderr, "dumpet: could not read \"%s\": %m\n", path);
+		free(data);
+		fclose(f);
+		return NULL;
+	}
+	fclose(f);
+	return data;
+}
+
+/* One --replace, checked against the image before anything is
+ * written. */
+struct replacement {
+	const char *spec;
+	long num;
+	struct boot_entry *entry;
+	const char *path;
+	Sector *data;
+	uint32_t size;
+	uint32_t sectors;
+	int found;
+	struct iso_file file;
+	int set_count;		/* rewrite the entry's sector count... */
+	uint16_t count;		/* ... to this */
+};
+
+/* UDF file entries can't be updated, so on a bridge image the file's
+ * size has to stay as it is. */
+static int has_udf(struct descriptor_set *set)
+{
+	int i;
+
+	for (i = 0; i < set->ndescriptors; i++)
+		if (!memcmp(set->descriptors[i].Id, "NSR02", 5) ||
+				!memcmp(set->descriptors[i].Id, "NSR03", 5))
+			return 1;
+	return 0;
+}
+
+/* Parse "<n>=<file>", read the file, and make sure it fits where entry
+ * <n>'s image is.
+ *
+ * If a file in the ISO 9660 hierarchy starts at the entry's LoadLBA, the
+ * space available runs up to the next extent anything else uses, and the
+ * file's size will be updated as well.  If there isn't one, only what the
+ * catalog entry itself describes can be overwritten. */
+static int check_replacement(struct context *context, struct boot_catalog *cat,
+			     struct file_map *map, struct replacement *r)
+{
+	struct iso_volume *vol = &context->volume->primary;
+	uint32_t next, capacity, count;
+	char *end;
+	int i;
+
+	errno = 0;
+	r->num = strtol(r->spec, &end, 0);
+	if (errno || end == r->spec || *end != '=' || !end[1] || r->num < 0 ||
+			r->num >= cat->nentries) {
+		fprintf(stderr, "dumpet: invalid replacement \"%s\"\n", r->spec);
+		return 2;
+	}
+	r->entry = &cat->entries[r->num];
+	r->path = end + 1;
+
+	r->data = read_new_image(r->path, &r->size, &r->sectors);
+	if (!r->data)
+		return 2;
+
+	r->found = find_file_by_extent(map, r->entry->LoadLBA, &r->file);
+	if (r->found) {
+		/* the catalog and the other boot images aren't necessarily
+		 * in the hierarchy */
+		next = r->file.next_extent;
+		if (cat->lba > r->entry->LoadLBA && cat->lba < next)
+			next = cat->lba;
+		for (i = 0; i < cat->nentries; i++) {
+			uint32_t lba = cat->entries[i].LoadLBA;
+			if (lba > r->entry->LoadLBA && lba < next)
+				next = lba;
+		}
+		capacity = next - r->entry->LoadLBA;
+	} else {
+		capacity = boot_entry_sectors(r->entry);
+	}
+
+	if (r->sectors > capacity) {
+		fprintf(stderr, "dumpet: \"%s\" needs %u sectors, but the "
+			"extent of entry %ld at LBA %u only has %u.\n",
+			r->path, r->sectors, r->num, r->entry->LoadLBA,
+			capacity);
+		fprintf(stderr, "dumpet: it must be relocated to a free extent "
+			"of at least %u sectors", r->sectors);
+		if (vol->has_pvd)
+			fprintf(stderr, ", e.g. at LBA %u after the end of "
+				"the volume", vol->VolumeSpaceSize);
+		fprintf(stderr, ".\n");
+		return 6;
+	}
+
+	if (r->found && r->file.size != r->size && has_udf(context->volume)) {
+		fprintf(stderr, "dumpet: \"%s\" is %u bytes and the file at "
+			"LBA %u is %u, but its UDF file entry can't be "
+			"updated.\n", r->path, r->size, r->entry->LoadLBA,
+			r->file.size);
+		return 6;
+	}
+
+	/* A no emulation entry that loaded all of the old image (an EFI
+	 * system partition image, say) has to load all of the new one.  One
+	 * that loads only the start of it, like isolinux's four virtual
+	 * sectors, still does.  Without a file, the entry is all there is
+	 * of the old image. */
+	count = (r->size + 511) / 512;
+	if (r->entry->BootMediaType == NoEmulation &&
+			(!r->found ||
+			 r->entry->SectorCount * 512 >= r->file.size) &&
+			r->entry->SectorCount != count) {
+		if (count > UINT16_MAX) {
+			fprintf(stderr, "dumpet: \"%s\" is too big for the "
+				"sector count of entry %ld to cover\n",
+				r->path, r->num);
+			return 6;
+		}
+		r->set_count = 1;
+		r->count = count;
+	}
+	return 0;
+}
+
+/* Two replacements can't both write the same sectors. */
+static int check_overlap(struct replacement *a, struct replacement *b)
+{
+	uint32_t x = a->entry->LoadLBA, y = b->entry->LoadLBA;
+
+	if (x < (uint64_t)y + b->sectors && y < (uint64_t)x + a->sectors) {
+		fprintf(stderr, "dumpet: replacements \"%s\" and \"%s\" "
+			"both write sector %u\n", a->spec, b->spec,
+			x > y ? x : y);
+		return 2;
+	}
+	return 0;
+}
+
+/* Overwrite the extent with the new image, writing only the sectors that
+ * actually differ, and update the file's size in every directory tree.
+ * A new sector count goes into the catalog, which is written after all of
+ * the images are. */
+static int write_replacement(struct context *context, struct file_map *map,
+			     struct replacement *r)
+{
+	struct boot_entry *entry = r->entry;
+	uint32_t written = 0, s;
+	Sector *old;
+	int rc = 0;
+
+	old = malloc(r->sectors * sizeof(Sector));
+	if (!old) {
+		fprintf(stderr, "dumpet: %m\n");
+		return 3;
+	}
+	if (read_sectors(context->iso, entry->LoadLBA, r->sectors, old) < 0) {
+		rc = 3;
+		goto out;
+	}
+
+	for (s = 0; s < r->sectors; ) {
+		uint32_t run = 0;
+
+		while (s + run < r->sectors &&
+				memcmp(old[s + run], r->data[s + run],
+				       sizeof(Sector)))
+			run++;
+		if (run) {
+			if (write_sectors(context->iso, entry->LoadLBA + s, run,
+					  &r->data[s]) < 0) {
+				rc = 3;
+				goto out;
+			}
+			written += run;
+			s += run;
+		} else {
+			s++;
+		}
+	}
+	if (fflush(context->iso) || fsync(fileno(context->iso)) < 0) {
+		fprintf(stderr, "dumpet: Error writing image: %m\n");
+		rc = 3;
+		goto out;
+	}
+
+	if (r->found && r->file.size != r->size &&
+			set_file_size(context->iso, map, &r->file, r->size) < 0) {
+		rc = 3;
+		goto out;
+	}
+
+	if (r->set_count) {
+		uint16_t count = cpu16_to_iso721(r->count);
+
+		memcpy(&entry->raw->SectionEntry.SectorCount, &count,
+		       sizeof(count));
+	}
+
+	fprintf(stderr, "dumpet: replaced boot image of entry %ld at LBA %u: "
+		"%u of %u sectors changed\n", r->num, entry->LoadLBA, written,
+		r->sectors);
+out:
+	free(old);
+	return rc;
+}
+
+/* Apply every --replace, or none of them: all of them are checked before
+ * the first is written. */
+int replace_boot_images(struct context *context, struct boot_catalog *cat)
+{
+	struct replacement *r;
+	struct file_map *map;
+	int i, j, rc = 0;
+
+	map = get_file_map(context);
+	if (!map)
+		return 3;
+
+	r = calloc(context->nreplacements, sizeof(*r));
+	if (!r) {
+		fprintf(stderr, "dumpet: %m\n");
+		return 3;
+	}
+	for (i = 0; i < context->nreplacements && rc == 0; i++) {
+		r[i].spec = context->replacements[i];
+		rc = check_replacement(context, cat, map, &r[i]);
+		for (j = 0; j < i && rc == 0; j++)
+			rc = check_overlap(&r[j], &r[i]);
+	}
+	for (i = 0; i < context->nreplacements && rc == 0; i++)
+		rc = write_replacement(context, map, &r[i]);
+
+	for (i = 0; i < context->nreplacements; i++)
+		free(r[i].data);
+	free(r);
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "dumpet.h"
+#include "catalog.h"
+#include "scan.h"
+#include "simd.h"
+
+#define MAX_SCAN_THREADS 64
+
+struct scan_chunk {
+	const uint8_t *base;
+	uint64_t first;
+	uint64_t nsectors;
+	uint64_t *hits;
+	size_t nhits;
+	int error;
+};
+
+static void *scan_chunk(void *arg)
+{
+	struct scan_chunk *chunk = arg;
+	const uint8_t *base = chunk->base + chunk->first * sizeof(Sector);
+	size_t max = 64;
+	size_t i;
+
+	for (;;) {
+		chunk->hits = malloc(max * sizeof(*chunk->hits));
+		if (!chunk->hits) {
+			chunk->error = -ENOMEM;
+			return NULL;
+		}
+		chunk->nhits = find_validation_entries(base, chunk->nsectors,
+						       chunk->hits, max);
+		if (chunk->nhits <= max)
+			break;
+		/* rare: lots of hits; go again with room for all of them */
+		max = chunk->nhits;
+		free(chunk->hits);
+	}
+	for (i = 0; i < chunk->nhits; i++)
+		chunk->hits[i] += chunk->first;
+	return NULL;
+}
+
+static int scan_threads(int requested, uint64_t nsectors)
+{
+	long n = requested;
+
+	if (n <= 0)
+		n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n <= 0)
+		n = 1;
+	if (n > MAX_SCAN_THREADS)
+		n = MAX_SCAN_THREADS;
+	/* not worth a thread for less than 8MB */
+	if (n > nsectors / 4096 + 1)
+		n = nsectors / 4096 + 1;
+	return n;
+}
+
+static void report_catalog(struct context *context, const uint8_t *base,
+			   uint64_t nsectors, uint64_t lba)
+{
+	struct boot_catalog *cat;
+	char platform[16];
+	char media[64];
+	int bootable = 0, outside = 0;
+	int i;
+
+	cat = calloc(1, sizeof(*cat));
+	if (!cat) {
+		fprintf(stderr, "dumpet: %m\n");
+		return;
+	}
+	cat->lba = lba;
+	memcpy(&cat->raw, base + lba * sizeof(Sector), sizeof(cat->raw));
+	parse_boot_catalog(cat);
+
+	for (i = 0; i < cat->nentries; i++) {
+		if (cat->entries[i].BootIndicator == Bootable)
+			bootable++;
+		if (cat->entries[i].LoadLBA >= nsectors)
+			outside++;
+	}
+
+	snprintPlatformId(platform, sizeof(platform),
+			  cat->headers[0].PlatformId);
+	printf("Validation Entry at sector %"PRIu64" (offset 0x%"PRIx64"):\n",
+	       lba, lba * (uint64_t)sizeof(Sector));
+	printf("\tPlatform Id: 0x%02x (%s)\n", cat->headers[0].PlatformId,
+	       platform);
+	printf("\tId: \"%s\"\n", cat->headers[0].Id);
+	printf("\tEntries: %d (%d bootable", cat->nentries, bootable);
+	if (outside)
+		printf(", %d past the end of the image", outside);
+	printf(")\n");
+
+	for (i = 0; i < cat->nentries; i++) {
+		struct boot_entry *entry = &cat->entries[i];
+
+		snprintBootMediaType(media, sizeof(media),
+				     entry->BootMediaType);
+		printf("\tEntry %d: %s, %s, LBA %"PRIu32", %"PRIu16
+		       " sectors\n", entry->filenum,
+		       entry->BootIndicator == Bootable ? "bootable"
+							 : "not bootable",
+		       media, entry->LoadLBA, entry->SectorCount);
+	}
+	free(cat);
+}
+
+/* Recovery mode: the volume descriptors may be damaged or absent (a raw
+ * dump, a partially overwritten disk), so look for catalogs directly.  A
+ * catalog starts on a sector boundary with a validation entry, which is
+ * distinctive enough to find by brute force.  The image is mapped and
+ * split into one contiguous run of sectors per thread. */
+int scan_image(struct context *context)
+{
+	struct scan_chunk chunks[MAX_SCAN_THREADS];
+	pthread_t threads[MAX_SCAN_THREADS];
+	int started[MAX_SCAN_THREADS] = { 0 };
+	int fd = fileno(context->iso);
+	struct stat sb;
+	uint8_t *base;
+	uint64_t size, nsectors, per;
+	size_t total = 0;
+	int nthreads, i, rc = 0;
+	size_t j;
+
+	if (fstat(fd, &sb) < 0) {
+		fprintf(stderr, "dumpet: could not stat \"%s\": %m\n",
+			context->filename);
+		return 3;
+	}
+	if (S_ISREG(sb.st_mode)) {
+		size = sb.st_size;
+	} else {
+		off_t end = lseek(fd, 0, SEEK_END);
+
+		if (end < 0) {
+			fprintf(stderr, "dumpet: could not size \"%s\": %m\n",
+				context->filename);
+			return 3;
+		}
+		size = end;
+	}
+	nsectors = size / sizeof(Sector);
+	if (nsectors == 0) {
+		fprintf(stderr, "dumpet: \"%s\" is smaller than one sector\n",
+			context->filename);
+		return 4;
+	}
+	if (size != (size_t)size) {
+		fprintf(stderr, "dumpet: \"%s\" is too large to map\n",
+			context->filename);
+		return 3;
+	}
+
+	stats_phase_begin(PhaseScan);
+	base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		fprintf(stderr, "dumpet: could not map \"%s\": %m\n",
+			context->filename);
+		stats_phase_end(PhaseScan);
+		return 3;
+	}
+	madvise(base, size, MADV_SEQUENTIAL);
+	iostats.bytes_read += nsectors * sizeof(Sector);
+
+	nthreads = scan_threads(context->threads, nsectors);
+	per = (nsectors + nthreads - 1) / nthreads;
+	for (i = 0; i < nthreads; i++) {
+		memset(&chunks[i], 0, sizeof(chunks[i]));
+		chunks[i].base = base;
+		chunks[i].first = per * i;
+		if (chunks[i].first < nsectors)
+			chunks[i].nsectors = nsectors - chunks[i].first;
+		if (chunks[i].nsectors > per)
+			chunks[i].nsectors = per;
+	}
+	/* the calling thread takes the first chunk itself */
+	for (i = 1; i < nthreads; i++) {
+		started[i] = pthread_create(&threads[i], NULL, scan_chunk,
+					    &chunks[i]) == 0;
+		if (!started[i])
+			scan_chunk(&chunks[i]);
+	}
+	scan_chunk(&chunks[0]);
+	for (i = 1; i < nthreads; i++)
+		if (started[i])
+			pthread_join(threads[i], NULL);
+	dumpet_probe2(scan__done, nsectors, nthreads);
+
+	/* chunks are in order, so the hits come out sorted by sector */
+	for (i = 0; i < nthreads; i++) {
+		if (chunks[i].error) {
+			fprintf(stderr, "dumpet: %s\n",
+				strerror(-chunks[i].error));
+			rc = 3;
+		}
+		for (j = 0; j < chunks[i].nhits; j++)
+			report_catalog(context, base, nsectors,
+				       chunks[i].hits[j]);
+		total += chunks[i].nhits;
+		free(chunks[i].hits);
+	}
+
+	munmap(base, size);
+	stats_phase_end(PhaseScan);
+
+	if (rc == 0 && total == 0) {
+		fprintf(stderr, "dumpet: no boot catalog found in %"PRIu64
+			" sectors of \"%s\"\n", nsectors, context->filename);
+		rc = 5;
+	}
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
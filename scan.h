@@ -0,0 +1,27 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SCAN_H
+#define SCAN_H
+
+#include "dumpet.h"
+
+/* Sweep the whole image for boot catalog validation entries, ignoring the
+ * volume descriptors entirely, and report every catalog that turns up. */
+extern int scan_image(struct context *context);
+
+#endif /* SCAN_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FIPS 180-4 SHA-256, fed incrementally. */
+
+#define SHA256_DIGEST_SIZE 32
+
+struct sha256_ctx {
+	uint32_t h[8];
+	uint64_t length;	/* bytes hashed so far */
+	size_t nbuf;
+	uint8_t buf[64];
+};
+
+extern void sha256_init(struct sha256_ctx *ctx);
+extern void sha256_update(struct sha256_ctx *ctx, const void *data,
+			  size_t len);
+extern void sha256_final(struct sha256_ctx *ctx,
+			 uint8_t digest[SHA256_DIGEST_SIZE]);
+
+#endif /* SHA256_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <endian.h>
+
+#include "simd.h"
+
+#define SECTOR_SIZE 2048
+
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+typedef uint16_t v8u16 __attribute__((vector_size(16)));
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+typedef uint8_t v32u8 __attribute__((vector_size(32)));
+
+/* Little endian words in each lane, swapped into host order.  (A macro,
+ * since passing 32-byte vectors to functions is an ABI question.) */
+#if __BYTE_ORDER == __BIG_ENDIAN
+#define le32_lanes(v) (((v) << 24) | (((v) << 8) & 0x00ff0000) |	\
+		       (((v) >> 8) & 0x0000ff00) | ((v) >> 24))
+#else
+#define le32_lanes(v) (v)
+#endif
+
+static const char base64_digits[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* One build has to run well from the oldest host to the newest, so the
+ * kernels are built for several instruction sets and the best one the
+ * CPU has is picked at startup.  Elsewhere the baseline is all there is;
+ * on aarch64 that already means NEON. */
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512vl")
+#define SIMD(name) name##_avx512
+#include "simd_kernels.h"
+#undef SIMD
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define SIMD(name) name##_avx2
+#include "simd_kernels.h"
+#undef SIMD
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2")
+#define SIMD(name) name##_sse42
+#include "simd_kernels.h"
+#undef SIMD
+#pragma GCC pop_options
+#endif
+
+#define SIMD(name) name##_generic
+#include "simd_kernels.h"
+#undef SIMD
+
+struct simd_variant {
+	const char *name;
+	int (*supported)(void);
+	size_t (*find_validation_entries)(const uint8_t *base,
+					  uint64_t nsectors, uint64_t *hits,
+					  size_t maxhits);
+	int (*is_zero)(const void *p, size_t len);
+	size_t (*trim_zeros)(const void *p, size_t len);
+	uint32_t (*sum_le32)(const void *p, size_t len);
+	size_t (*base64_encode)(const void *in, size_t len, char *out);
+};
+
+#define SIMD_VARIANT(label, suffix, test) {				\
+	.name = label,							\
+	.supported = test,						\
+	.find_validation_entries = find_validation_entries_##suffix,	\
+	.is_zero = is_zero_##suffix,					\
+	.trim_zeros = trim_zeros_##suffix,				\
+	.sum_le32 = sum_le32_##suffix,					\
+	.base64_encode = base64_encode_##suffix,			\
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static int has_avx512(void)
+{
+	return __builtin_cpu_supports("avx512f") &&
+	       __builtin_cpu_supports("avx512bw") &&
+	       __builtin_cpu_supports("avx512vl");
+}
+
+static int has_avx2(void)
+{
+	return __builtin_cpu_supports("avx2");
+}
+
+static int has_sse42(void)
+{
+	return __builtin_cpu_supports("sse4.2");
+}
+#endif
+
+static int always(void)
+{
+	return 1;
+}
+
+/* In order of preference.  The kernels work on 256-bit vectors, which
+ * AVX-512 only re-encodes, and it measured no faster than AVX2, so it has
+ * to be asked for. */
+static const struct simd_variant variants[] = {
+#if defined(__x86_64__) || defined(__i386__)
+	SIMD_VARIANT("avx2", avx2, has_avx2),
+	SIMD_VARIANT("avx512", avx512, has_avx512),
+	SIMD_VARIANT("sse4.2", sse42, has_sse42),
+#endif
+	SIMD_VARIANT("generic", generic, always),
+};
+
+#define NVARIANTS (sizeof(variants) / sizeof(variants[0]))
+
+static const struct simd_variant *simd = &variants[NVARIANTS - 1];
+
+int simd_select(const char *name)
+{
+	int i;
+
+	for (i = 0; i < NVARIANTS; i++) {
+		if (name && *name && strcmp(name, variants[i].name))
+			continue;
+		if (variants[i].supported()) {
+			simd = &variants[i];
+			return 0;
+		}
+		if (name && *name) {
+			fprintf(stderr, "dumpet: this CPU can't run the %s "
+				"kernels\n", name);
+			return -1;
+		}
+	}
+
+	fprintf(stderr, "dumpet: unknown SIMD variant \"%s\"; this build has",
+		name);
+	for (i = 0; i < NVARIANTS; i++)
+		fprintf(stderr, " %s", variants[i].name);
+	fprintf(stderr, "\n");
+	return -1;
+}
+
+const char *simd_variant(void)
+{
+	return simd->name;
+}
+
+size_t find_validation_entries(const uint8_t *base, uint64_t nsectors,
+			       uint64_t *hits, size_t maxhits)
+{
+	return simd->find_validation_entries(base, nsectors, hits, maxhits);
+}
+
+int is_zero(const void *p, size_t len)
+{
+	return simd->is_zero(p, len);
+}
+
+size_t trim_zeros(const void *p, size_t len)
+{
+	return simd->trim_zeros(p, len);
+}
+
+uint32_t sum_le32(const void *p, size_t len)
+{
+	return simd->sum_le32(p, len);
+}
+
+size_t base64_encode(const void *in, size_t len, char *out)
+{
+	return simd->base64_encode(in, len, out);
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Data-parallel helpers.  These are written with GCC's generic vector
+ * extensions, so they use whatever SIMD unit the target has and are
+ * lowered to plain scalar code where there isn't one.  On x86 they are
+ * built for AVX-512, AVX2 and SSE4.2 as well as the baseline, and each
+ * call goes to the variant simd_select() picked. */
+
+/* Use the named variant ("avx2", "avx512", "sse4.2" or "generic"), or
+ * the best one this CPU can run if name is NULL or empty.  Returns -1,
+ * having said why, if the variant is unknown or the CPU lacks it.
+ * Until this is called, the generic variant is used. */
+extern int simd_select(const char *name);
+
+/* The name of the variant in use. */
+extern const char *simd_variant(void);
+
+/* Find the 2048-byte sectors in [base, base + nsectors * 2048) that start
+ * with a boot catalog validation entry: header indicator 0x01, key bytes
+ * 0x55 0xaa, and a 16-bit word sum of zero.  The sector numbers (relative
+ * to base) are stored in hits, up to maxhits of them; the return value is
+ * how many were found in total. */
+extern size_t find_validation_entries(const uint8_t *base, uint64_t nsectors,
+				      uint64_t *hits, size_t maxhits);
+
+/* Whether len bytes at p are all zero. */
+extern int is_zero(const void *p, size_t len);
+
+/* The length of the buffer with any trailing zero bytes left off. */
+extern size_t trim_zeros(const void *p, size_t len);
+
+/* The sum, modulo 2^32, of the little endian 32-bit words at p, the last
+ * one zero-padded if len isn't a multiple of four.  A long sum can be
+ * taken in pieces as long as each piece but the last is a multiple of
+ * four bytes long. */
+extern uint32_t sum_le32(const void *p, size_t len);
+
+/* RFC 4648 base64, with padding and without line breaks.  out needs room
+ * for BASE64_LENGTH(len) bytes; the number written is returned.  Input
+ * can be encoded in pieces as long as each piece but the last is a
+ * multiple of three bytes long. */
+#define BASE64_LENGTH(len) (((len) + 2) / 3 * 4)
+extern size_t base64_encode(const void *in, size_t len, char *out);
+
+#endif /* SIMD_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* The kernels behind simd.h, written once with GCC's generic vectors and
+ * compiled once per instruction set: simd.c includes this file several
+ * times, each time under a different "#pragma GCC target" and with SIMD()
+ * defined to give the functions that variant's suffix. */
+
+/* The sum of the sixteen little endian words of a validation entry. */
+static inline uint16_t SIMD(validation_entry_sum)(const uint8_t *p)
+{
+	v8u16 a, b;
+	uint16_t sum = 0;
+	int i;
+
+	memcpy(&a, p, sizeof(a));
+	memcpy(&b, p + sizeof(a), sizeof(b));
+	a += b;
+#if __BYTE_ORDER == __BIG_ENDIAN
+	a = (a << 8) | (a >> 8);
+#endif
+	for (i = 0; i < 8; i++)
+		sum += a[i];
+	return sum;
+}
+
+static size_t SIMD(find_validation_entries)(const uint8_t *base,
+					    uint64_t nsectors, uint64_t *hits,
+					    size_t maxhits)
+{
+	/* bytes 28-31 are the checksum and the key bytes */
+	const uint32_t key = 0x55 << 16 | 0xaa << 24;
+	const v8u32 keys = { key, key, key, key, key, key, key, key };
+	const v8u32 keymask = { 0xffff0000, 0xffff0000, 0xffff0000, 0xffff0000,
+				0xffff0000, 0xffff0000, 0xffff0000, 0xffff0000 };
+	const v8u32 ones = { 1, 1, 1, 1, 1, 1, 1, 1 };
+	size_t found = 0;
+	uint64_t s = 0;
+
+	/* First pass, eight sectors at a time: gather each sector's header
+	 * indicator and key bytes and compare them all at once.  Nearly
+	 * every batch is rejected here. */
+	for (; s + 8 <= nsectors; s += 8) {
+		const uint8_t *p = base + s * SECTOR_SIZE;
+		v8u32 tail, head, match;
+		int k;
+
+		for (k = 0; k < 8; k++) {
+			uint32_t t;
+
+			memcpy(&t, p + k * SECTOR_SIZE + 28, sizeof(t));
+			tail[k] = le32toh(t);
+			head[k] = p[k * SECTOR_SIZE];
+		}
+		match = ((tail & keymask) == keys) & (head == ones);
+		for (k = 0; k < 8; k++) {
+			if (!match[k])
+				continue;
+			if (SIMD(validation_entry_sum)(p + k * SECTOR_SIZE) != 0)
+				continue;
+			if (found < maxhits)
+				hits[found] = s + k;
+			found++;
+		}
+	}
+
+	for (; s < nsectors; s++) {
+		const uint8_t *p = base + s * SECTOR_SIZE;
+
+		if (p[0] != 0x01 || p[30] != 0x55 || p[31] != 0xaa)
+			continue;
+		if (SIMD(validation_entry_sum)(p) != 0)
+			continue;
+		if (found < maxhits)
+			hits[found] = s;
+		found++;
+	}
+	return found;
+}
+
+/* OR everything together 128 bytes at a time and test once per block, so
+ * the loop body is nothing but wide loads and ORs. */
+static int SIMD(is_zero)(const void *p, size_t len)
+{
+	const uint8_t *b = p;
+	v4u64 acc = { 0, 0, 0, 0 };
+
+	for (; len >= 128; b += 128, len -= 128) {
+		v4u64 v0, v1, v2, v3;
+
+		memcpy(&v0, b, sizeof(v0));
+		memcpy(&v1, b + 32, sizeof(v1));
+		memcpy(&v2, b + 64, sizeof(v2));
+		memcpy(&v3, b + 96, sizeof(v3));
+		acc |= (v0 | v1) | (v2 | v3);
+		if ((acc[0] | acc[1] | acc[2] | acc[3]) != 0)
+			return 0;
+	}
+	for (; len > 0; b++, len--)
+		if (*b)
+			return 0;
+	return 1;
+}
+
+/* Four eight-lane accumulators, 128 bytes a step, so that the adds don't
+ * wait on each other; the lanes are only folded together at the end. */
+static uint32_t SIMD(sum_le32)(const void *p, size_t len)
+{
+	const uint8_t *b = p;
+	v8u32 a0 = { 0 }, a1 = { 0 }, a2 = { 0 }, a3 = { 0 };
+	uint32_t sum = 0, w;
+	int i;
+
+	for (; len >= 128; b += 128, len -= 128) {
+		v8u32 v0, v1, v2, v3;
+
+		memcpy(&v0, b, sizeof(v0));
+		memcpy(&v1, b + 32, sizeof(v1));
+		memcpy(&v2, b + 64, sizeof(v2));
+		memcpy(&v3, b + 96, sizeof(v3));
+		a0 += le32_lanes(v0);
+		a1 += le32_lanes(v1);
+		a2 += le32_lanes(v2);
+		a3 += le32_lanes(v3);
+	}
+	a0 += a1 + (a2 + a3);
+	for (i = 0; i < 8; i++)
+		sum += a0[i];
+
+	for (; len >= 4; b += 4, len -= 4) {
+		memcpy(&w, b, sizeof(w));
+		sum += le32toh(w);
+	}
+	if (len) {
+		w = 0;
+		memcpy(&w, b, len);
+		sum += le32toh(w);
+	}
+	return sum;
+}
+
+/* Eight 3-byte groups become 32 characters per step.  Each group's six
+ * bit indices are split out with shifts in its own 32-bit lane, and then
+ * turned into digits for all 32 at once: every index gets 'A' added, and
+ * the ranges past 'Z' are corrected with compare masks rather than a
+ * table lookup. */
+static size_t SIMD(base64_encode)(const void *in, size_t len, char *out)
+{
+	const uint8_t *p = in;
+	const v8u32 six = { 63, 63, 63, 63, 63, 63, 63, 63 };
+	char *o = out;
+
+	for (; len >= 24; p += 24, len -= 24, o += 32) {
+		v8u32 g, ix;
+		v32u8 d;
+		int k;
+
+		for (k = 0; k < 8; k++)
+			g[k] = p[k * 3] << 16 | p[k * 3 + 1] << 8 |
+			       p[k * 3 + 2];
+#if __BYTE_ORDER == __BIG_ENDIAN
+		ix = (g >> 18 & six) << 24 | (g >> 12 & six) << 16 |
+		     (g >> 6 & six) << 8 | (g & six);
+#else
+		ix = (g >> 18 & six) | (g >> 12 & six) << 8 |
+		     (g >> 6 & six) << 16 | (g & six) << 24;
+#endif
+		d = (v32u8)ix;
+		d += 'A' + ((v32u8)(d > 25) & (uint8_t)('a' - 'A' - 26)) +
+		     ((v32u8)(d > 51) & (uint8_t)('0' - 'a' - 26)) +
+		     ((v32u8)(d > 61) & (uint8_t)('+' - '0' - 10)) +
+		     ((v32u8)(d > 62) & (uint8_t)('/' - '+' - 1));
+		memcpy(o, &d, sizeof(d));
+	}
+
+	for (; len >= 3; p += 3, len -= 3, o += 4) {
+		o[0] = base64_digits[p[0] >> 2];
+		o[1] = base64_digits[(p[0] & 3) << 4 | p[1] >> 4];
+		o[2] = base64_digits[(p[1] & 15) << 2 | p[2] >> 6];
+		o[3] = base64_digits[p[2] & 63];
+	}
+	if (len) {
+		o[0] = base64_digits[p[0] >> 2];
+		if (len == 2) {
+			o[1] = base64_digits[(p[0] & 3) << 4 | p[1] >> 4];
+			o[2] = base64_digits[(p[1] & 15) << 2];
+		} else {
+			o[1] = base64_digits[(p[0] & 3) << 4];
+			o[2] = '=';
+		}
+		o[3] = '=';
+		o += 4;
+	}
+	return o - out;
+}
+
+static size_t SIMD(trim_zeros)(const void *p, size_t len)
+{
+	const uint8_t *b = p;
+
+	/* skip whole zero sectors from the end, then finish bytewise */
+	while (len >= SECTOR_SIZE &&
+			SIMD(is_zero)(b + len - SECTOR_SIZE, SECTOR_SIZE))
+		len -= SECTOR_SIZE;
+	while (len > 0 && b[len - 1] == 0)
+		len--;
+	return len;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dumpet.h"
+#include "source.h"
+
+static ssize_t mem_read(struct byte_source *src, uint64_t offset, void *buf,
+			size_t len)
+{
+	struct mem_source *ms = (struct mem_source *)src;
+
+	memcpy(buf, ms->data + offset, len);
+	return len;
+}
+
+void mem_source_init(struct mem_source *ms, const void *data, uint64_t size)
+{
+	ms->src.read = mem_read;
+	ms->src.size = size;
+	ms->data = data;
+}
+
+static ssize_t iso_read(struct byte_source *src, uint64_t offset, void *buf,
+			size_t len)
+{
+	struct iso_source *is = (struct iso_source *)src;
+	uint64_t end = (is->base + src->size + sizeof(Sector) - 1) /
+		       sizeof(Sector);
+	size_t done = 0;
+
+	while (done < len) {
+		uint32_t sector = (is->base + offset + done) / sizeof(Sector);
+		uint32_t skip = (is->base + offset + done) % sizeof(Sector);
+		size_t avail, n;
+
+		if (sector < is->first || sector >= is->first + is->count) {
+			int rc, want = ISO_SOURCE_WINDOW;
+
+			if (end - sector < want)
+				want = end - sector;
+			rc = read_sectors_upto(is->iso, sector, want,
+					       is->window);
+			if (rc < 0)
+				return rc;
+			is->first = sector;
+			is->count = rc;
+			if (rc == 0)
+				break;
+		}
+		avail = (is->first + is->count - sector) * sizeof(Sector) - skip;
+		n = len - done < avail ? len - done : avail;
+		memcpy((uint8_t *)buf + done,
+		       (uint8_t *)&is->window[sector - is->first] + skip, n);
+		done += n;
+	}
+	return done;
+}
+
+int iso_source_init(struct iso_source *is, FILE *iso, uint64_t base,
+		    uint64_t size)
+{
+	is->src.read = iso_read;
+	is->src.size = size;
+	is->iso = iso;
+	is->base = base;
+	is->first = 0;
+	is->count = 0;
+	is->window = malloc(ISO_SOURCE_WINDOW * sizeof(Sector));
+	if (!is->window)
+		return -errno;
+	return 0;
+}
+
+void iso_source_fini(struct iso_source *is)
+{
+	free(is->window);
+	is->window = NULL;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
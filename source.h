@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "iso9660.h"
+
+/* Something that can be read at any byte offset: a boot image inside the
+ * ISO, one already in memory, or a file inside a FAT image.  read()
+ * returns the number of bytes read, which is short only at the end of
+ * the source, or -errno. */
+struct byte_source {
+	ssize_t (*read)(struct byte_source *src, uint64_t offset, void *buf,
+			size_t len);
+	uint64_t size;
+};
+
+static inline ssize_t source_read(struct byte_source *src, uint64_t offset,
+				  void *buf, size_t len)
+{
+	if (offset >= src->size)
+		return 0;
+	if (len > src->size - offset)
+		len = src->size - offset;
+	return src->read(src, offset, buf, len);
+}
+
+struct mem_source {
+	struct byte_source src;
+	const uint8_t *data;
+};
+
+/* Reads go through a window of whole sectors, so streaming through the
+ * image costs one read per window rather than one per caller. */
+#define ISO_SOURCE_WINDOW 64
+
+struct iso_source {
+	struct byte_source src;
+	FILE *iso;
+	uint64_t base;		/* byte offset of the source in the image */
+	uint32_t first;		/* first sector in the window */
+	uint32_t count;		/* sectors in the window */
+	Sector *window;
+};
+
+extern void mem_source_init(struct mem_source *ms, const void *data,
+			    uint64_t size);
+extern int iso_source_init(struct iso_source *is, FILE *iso, uint64_t base,
+			   uint64_t size);
+extern void iso_source_fini(struct iso_source *is);
+
+#endif /* SOURCE_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "stats.h"
+#include "simd.h"
+
+struct iostats iostats;
+
+static const char *phase_names[NumPhases] = {
+	[PhaseBootRecord] = "boot record",
+	[PhaseCatalog] = "catalog",
+	[PhaseExtract] = "extraction",
+	[PhaseText] = "text output",
+	[PhaseXml] = "XML output",
+	[PhaseScan] = "recovery scan",
+	[PhaseArchive] = "archive output",
+	[PhaseClassify] = "classification",
+	[PhaseAuthenticode] = "authenticode",
+	[PhaseHfs] = "HFS+ lookup",
+	[PhaseMediaCheck] = "media check",
+	[PhaseBootInfo] = "boot info",
+	[PhaseFingerprint] = "fingerprint",
+};
+
+struct phase_stats {
+	uint64_t nsecs;
+	struct iostats io;
+};
+
+static struct phase_stats phases[NumPhases];
+static uint64_t xml_bytes;
+
+/* Phases nest (extraction happens while the catalog is being walked), so
+ * time and I/O are charged only to the innermost phase that is running. */
+static Phase phase_stack[NumPhases];
+static uint64_t phase_started[NumPhases];
+static int phase_depth;
+static uint64_t phase_mark;
+static struct iostats io_mark;
+
+static uint64_t now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void charge(Phase phase, uint64_t when)
+{
+	struct phase_stats *ps = &phases[phase];
+
+	ps->nsecs += when - phase_mark;
+	ps->io.reads += iostats.reads - io_mark.reads;
+	ps->io.writes += iostats.writes - io_mark.writes;
+	ps->io.seeks += iostats.seeks - io_mark.seeks;
+	ps->io.bytes_read += iostats.bytes_read - io_mark.bytes_read;
+	ps->io.bytes_written += iostats.bytes_written - io_mark.bytes_written;
+}
+
+void stats_phase_begin(Phase phase)
+{
+	uint64_t when = now();
+
+	if (phase_depth > 0)
+		charge(phase_stack[phase_depth - 1], when);
+	assert(phase_depth < NumPhases);
+	if (phase_depth < NumPhases) {
+		phase_stack[phase_depth] = phase;
+		phase_started[phase_depth++] = when;
+	}
+	phase_mark = when;
+	io_mark = iostats;
+	dumpet_probe1(phase__start, phase);
+}
+
+void stats_phase_end(Phase phase)
+{
+	uint64_t when = now();
+
+	/* every end has to match the innermost begin */
+	assert(phase_depth > 0 && phase_stack[phase_depth - 1] == phase);
+	if (phase_depth == 0 || phase_stack[phase_depth - 1] != phase)
+		return;
+	charge(phase, when);
+	phase_depth--;
+	dumpet_probe2(phase__done, phase, when - phase_started[phase_depth]);
+	phase_mark = when;
+	io_mark = iostats;
+}
+
+void stats_xml_written(uint64_t bytes)
+{
+	xml_bytes += bytes;
+	dumpet_probe1(xml__write, bytes);
+}
+
+static void print_row(const char *name, struct phase_stats *ps)
+{
+	fprintf(stderr, "\t%-14s %10.3f %8" PRIu64 " %8" PRIu64 " %8" PRIu64
+		" %12" PRIu64 " %14" PRIu64 "\n", name, ps->nsecs / 1000000.0,
+		ps->io.reads, ps->io.writes, ps->io.seeks, ps->io.bytes_read,
+		ps->io.bytes_written);
+}
+
+static void stats_report(void)
+{
+	struct phase_stats total = { 0 };
+	struct rusage ru;
+	int i;
+
+	/* close out anything still running, e.g. after an early exit() */
+	while (phase_depth > 0)
+		stats_phase_end(phase_stack[phase_depth - 1]);
+
+	fprintf(stderr, "dumpet statistics:\n");
+	fprintf(stderr, "\t%-14s %10s %8s %8s %8s %12s %14s\n", "phase",
+		"time (ms)", "reads", "writes", "seeks", "bytes read",
+		"bytes written");
+	for (i = 0; i < NumPhases; i++) {
+		print_row(phase_names[i], &phases[i]);
+		total.nsecs += phases[i].nsecs;
+	}
+	total.io = iostats;
+	print_row("total", &total);
+
+	fprintf(stderr, "\tXML bytes written: %" PRIu64 "\n", xml_bytes);
+	fprintf(stderr, "\tVector kernels: %s\n", simd_variant());
+	if (getrusage(RUSAGE_SELF, &ru) == 0)
+		fprintf(stderr, "\tPeak RSS: %ld KiB\n", ru.ru_maxrss);
+}
+
+void stats_enable(void)
+{
+	atexit(stats_report);
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+/* USDT probes, so that production runs can be traced with perf or
+ * bpftrace.  All probes live in the "dumpet" provider:
+ *
+ * read_sector(sector, count, rc)	after every image read
+ * write_sector(sector, count, rc)	after every image write
+ * phase__start(phase)			when a phase is entered
+ * phase__done(phase, nsecs)		when a phase is left, with the time
+ *					since it was entered
+ * xml__write(bytes)			when the XML document is emitted
+ * scan__done(sectors, threads)		when a --scan sweep finishes
+ */
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#define dumpet_probe1(name, a)		DTRACE_PROBE1(dumpet, name, a)
+#define dumpet_probe2(name, a, b)	DTRACE_PROBE2(dumpet, name, a, b)
+#define dumpet_probe3(name, a, b, c)	DTRACE_PROBE3(dumpet, name, a, b, c)
+#else
+#define dumpet_probe1(name, a)		do { } while (0)
+#define dumpet_probe2(name, a, b)	do { } while (0)
+#define dumpet_probe3(name, a, b, c)	do { } while (0)
+#endif
+
+typedef enum {
+	PhaseBootRecord,
+	PhaseCatalog,
+	PhaseExtract,
+	PhaseText,
+	PhaseXml,
+	PhaseScan,
+	PhaseArchive,
+	PhaseClassify,
+	PhaseAuthenticode,
+	PhaseHfs,
+	PhaseMediaCheck,
+	PhaseBootInfo,
+	PhaseFingerprint,
+	NumPhases
+} Phase;
+
+struct iostats {
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t seeks;
+	uint64_t bytes_read;
+	uint64_t bytes_written;
+};
+
+extern struct iostats iostats;
+
+extern void stats_phase_begin(Phase phase);
+extern void stats_phase_end(Phase phase);
+extern void stats_xml_written(uint64_t bytes);
+extern void stats_enable(void);
+
+#endif /* STATS_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,286 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+
+#include "dumpet.h"
+#include "render.h"
+#include "store.h"
+
+struct store {
+	char *dir;
+	char *manifest;		/* final name... */
+	char *manifest_tmp;	/* ... and where it's written until then */
+	FILE *out;
+	int error;
+};
+
+static int make_dir(const char *path)
+{
+	if (mkdir(path, 0755) < 0 && errno != EEXIST) {
+		int errnum = errno;
+		fprintf(stderr, "dumpet: Could not create \"%s\": %m\n", path);
+		return -errnum;
+	}
+	return 0;
+}
+
+/* The manifest is named by the image's absolute path with '%' and '/'
+ * escaped, so /a/x.iso and /b/x.iso get one each and a run that names the
+ * same image by another path finds the same manifest.  A name too long for
+ * the file system becomes the path's SHA-256 instead. */
+static char *manifest_name(struct context *context)
+{
+	uint8_t digest[SHA256_DIGEST_SIZE];
+	struct sha256_ctx ctx;
+	char *path, *name, *s;
+	const char *p;
+	size_t i;
+
+	if (!strcmp(context->filename, "-"))
+		return strdup("stdin");
+
+	path = realpath(context->filename, NULL);
+	if (!path)
+		return NULL;
+	name = malloc(strlen(path) * 3 + 1);
+	if (!name) {
+		free(path);
+		return NULL;
+	}
+	for (p = path, s = name; *p; p++) {
+		if (*p == '%' || *p == '/')
+			s += sprintf(s, "%%%02X", *p);
+		else
+			*s++ = *p;
+	}
+	*s = '\0';
+
+	/* leave room for mkstemp()'s ".XXXXXX" */
+	if (strlen(name) > NAME_MAX - 7) {
+		sha256_init(&ctx);
+		sha256_update(&ctx, path, strlen(path));
+		sha256_final(&ctx, digest);
+		for (i = 0; i < sizeof(digest); i++)
+			sprintf(name + i * 2, "%02x", digest[i]);
+	}
+	free(path);
+	return name;
+}
+
+struct store *store_open(struct context *context)
+{
+	struct store *store;
+	char *path = NULL, *name;
+	int fd;
+
+	store = calloc(1, sizeof(*store));
+	if (!store)
+		goto nomem;
+	store->dir = context->storeDir;
+
+	if (make_dir(store->dir) < 0)
+		goto err;
+	if (asprintf(&path, "%s/objects", store->dir) < 0)
+		goto nomem;
+	if (make_dir(path) < 0)
+		goto err;
+	free(path);
+	if (asprintf(&path, "%s/manifests", store->dir) < 0)
+		goto nomem;
+	if (make_dir(path) < 0)
+		goto err;
+
+	/* the manifest only appears once it's complete */
+	name = manifest_name(context);
+	if (!name ||
+	    asprintf(&store->manifest, "%s/%s", path, name) < 0 ||
+	    asprintf(&store->manifest_tmp, "%s.XXXXXX", store->manifest) < 0) {
+		free(name);
+		goto nomem;
+	}
+	free(name);
+	free(path);
+	path = NULL;
+
+	fd = mkstemp(store->manifest_tmp);
+	if (fd < 0 || !(store->out = fdopen(fd, "w"))) {
+		fprintf(stderr, "dumpet: Could not create \"%s\": %m\n",
+			store->manifest_tmp);
+		goto err;
+	}
+	fchmod(fd, 0644);
+	fprintf(store->out, "# %s\n", context->filename);
+	return store;
+
+nomem:
+	fprintf(stderr, "dumpet: %m\n");
+err:
+	free(path);
+	if (store) {
+		free(store->manifest);
+		free(store->manifest_tmp);
+		free(store);
+	}
+	return NULL;
+}
+
+/* Write a new object next to where it goes and rename it into place, so
+ * an object that exists is always whole. */
+static int write_object(struct boot_image *image, const char *path)
+{
+	char *tmp;
+	FILE *file;
+	int fd, rc;
+
+	if (asprintf(&tmp, "%s.XXXXXX", path) < 0)
+		return -errno;
+	fd = mkstemp(tmp);
+	if (fd < 0 || !(file = fdopen(fd, "w+"))) {
+		rc = -errno;
+		fprintf(stderr, "dumpet: Could not create \"%s\": %m\n", tmp);
+		if (fd >= 0) {
+			close(fd);
+			unlink(tmp);
+		}
+		free(tmp);
+		return rc;
+	}
+
+	rc = write_boot_image(file, image);
+	if (rc == 0 && fchmod(fd, 0444) < 0)
+		rc = -errno;
+	if (fclose(file) != 0 && rc == 0)
+		rc = -errno;
+	if (rc == 0 && rename(tmp, path) < 0) {
+		rc = -errno;
+		fprintf(stderr, "dumpet: Could not rename \"%s\": %m\n", tmp);
+	}
+	if (rc < 0)
+		unlink(tmp);
+	free(tmp);
+	return rc;
+}
+
+int store_boot_image(struct store *store, struct boot_entry *entry,
+		     struct boot_image *image, struct store_object *object)
+{
+	uint64_t size = (uint64_t)image->nread * sizeof(Sector);
+	uint8_t digest[SHA256_DIGEST_SIZE];
+	struct sha256_ctx ctx;
+	char platform[16];
+	char *dir = NULL;
+	struct stat sb;
+	int i, rc;
+
+	memset(object, '\0', sizeof(*object));
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, image->data, size);
+	sha256_final(&ctx, digest);
+	for (i = 0; i < sizeof(digest); i++)
+		sprintf(object->digest + i * 2, "%02x", digest[i]);
+
+	if (asprintf(&dir, "%s/objects/%.2s", store->dir,
+		     object->digest) < 0 ||
+	    asprintf(&object->path, "%s/%s", dir, object->digest + 2) < 0) {
+		rc = -errno;
+		fprintf(stderr, "dumpet: %m\n");
+		object->path = NULL;
+		goto out;
+	}
+
+	/* already there: nothing to write */
+	rc = 0;
+	if (stat(object->path, &sb) < 0 || sb.st_size != size) {
+		rc = make_dir(dir);
+		if (rc == 0)
+			rc = write_object(image, object->path);
+		if (rc == 0)
+			object->new = 1;
+	}
+
+	snprintPlatformId(platform, sizeof(platform), entry->PlatformId);
+	fprintf(store->out, "%s %d %u %"PRIu64" %s\n", object->digest,
+		entry->filenum, entry->LoadLBA, size, platform);
+out:
+	if (rc < 0)
+		store->error = rc;
+	free(dir);
+	return rc;
+}
+
+/* Make path another name for the object: a hard link if possible, a
+ * reflink if the store is on another file system that can share blocks
+ * with this one.  If neither works the caller has to write a copy. */
+int store_link(struct store_object *object, const char *path)
+{
+	int in, out, rc;
+
+	unlink(path);
+	if (link(object->path, path) == 0)
+		return 0;
+
+	in = open(object->path, O_RDONLY);
+	if (in < 0)
+		return -errno;
+	out = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (out < 0) {
+		rc = -errno;
+		close(in);
+		return rc;
+	}
+	rc = ioctl(out, FICLONE, in) < 0 ? -errno : 0;
+	close(out);
+	close(in);
+	if (rc < 0)
+		unlink(path);
+	return rc;
+}
+
+int store_close(struct store *store)
+{
+	int rc = store->error;
+
+	if (fclose(store->out) != 0 && rc == 0)
+		rc = -errno;
+	if (rc == 0 && rename(store->manifest_tmp, store->manifest) < 0) {
+		rc = -errno;
+		fprintf(stderr, "dumpet: Could not rename \"%s\": %m\n",
+			store->manifest_tmp);
+	}
+	if (rc < 0)
+		unlink(store->manifest_tmp);
+	free(store->manifest);
+	free(store->manifest_tmp);
+	free(store);
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STORE_H
+#define STORE_H
+
+#include <stdio.h>
+
+#include "sha256.h"
+
+/* A content-addressed directory of boot images, shared between runs:
+ *
+ *	<dir>/objects/ab/cdef...	each distinct image, once, read-only
+ *	<dir>/manifests/%2Fpath%2Fiso	which images each ISO refers to
+ *
+ * Objects are named by the SHA-256 of their content, so an image that's
+ * already there is recognized before anything is written. */
+
+struct context;
+struct boot_entry;
+struct boot_image;
+
+struct store_object {
+	char digest[SHA256_DIGEST_SIZE * 2 + 1];
+	char *path;
+	int new;		/* written by this run */
+};
+
+struct store;
+
+extern struct store *store_open(struct context *context);
+extern int store_boot_image(struct store *store, struct boot_entry *entry,
+			    struct boot_image *image,
+			    struct store_object *object);
+extern int store_link(struct store_object *object, const char *path);
+extern int store_close(struct store *store);
+
+#endif /* STORE_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <errno.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "stats.h"
+#include "stream.h"
+
+/* how much to read and drop at once when skipping ahead */
+#define STREAM_CHUNK 256
+
+struct sector_stream *input_stream;
+
+struct sector_stream *stream_open(FILE *in)
+{
+	struct sector_stream *s;
+
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return NULL;
+	s->scratch = malloc(STREAM_CHUNK * sizeof(Sector));
+	if (!s->scratch) {
+		free(s);
+		return NULL;
+	}
+	s->in = in;
+	s->keep_reads = 1;
+	return s;
+}
+
+int stream_want(struct sector_stream *s, uint32_t lba, uint32_t count)
+{
+	struct stream_range *new;
+
+	if (count == 0)
+		return 0;
+	new = realloc(s->wanted, (s->nwanted + 1) * sizeof(*new));
+	if (!new)
+		return -errno;
+	s->wanted = new;
+	s->wanted[s->nwanted].lba = lba;
+	s->wanted[s->nwanted].count = count;
+	s->nwanted++;
+	return 0;
+}
+
+static int is_wanted(struct sector_stream *s, uint32_t lba)
+{
+	int i;
+
+	for (i = 0; i < s->nwanted; i++)
+		if (lba >= s->wanted[i].lba &&
+				lba - s->wanted[i].lba < s->wanted[i].count)
+			return 1;
+	return 0;
+}
+
+/* Input only moves forward, so each run kept starts at or after the end
+ * of the last one, and the list stays sorted by just appending. */
+static int keep(struct sector_stream *s, uint32_t lba, uint32_t count,
+		const Sector *data)
+{
+	struct stream_extent *last = s->nkept ? &s->kept[s->nkept - 1] : NULL;
+
+	if (count == 0)
+		return 0;
+	if (last && last->lba + last->count == lba) {
+		Sector *grown = realloc(last->data, (last->count + count) *
+					sizeof(Sector));
+
+		if (!grown)
+			return -errno;
+		memcpy(&grown[last->count], data, count * sizeof(Sector));
+		last->data = grown;
+		last->count += count;
+		return 0;
+	} else {
+		struct stream_extent *new;
+
+		new = realloc(s->kept, (s->nkept + 1) * sizeof(*new));
+		if (!new)
+			return -errno;
+		s->kept = new;
+		last = &s->kept[s->nkept];
+		last->data = malloc(count * sizeof(Sector));
+		if (!last->data)
+			return -errno;
+		memcpy(last->data, data, count * sizeof(Sector));
+		last->lba = lba;
+		last->count = count;
+		s->nkept++;
+		return 0;
+	}
+}
+
+static int keep_wanted(struct sector_stream *s, uint32_t lba, uint32_t count,
+		       const Sector *data)
+{
+	uint32_t i, j;
+	int rc;
+
+	for (i = 0; i < count; i = j) {
+		while (i < count && !is_wanted(s, lba + i))
+			i++;
+		for (j = i; j < count && is_wanted(s, lba + j); j++)
+			;
+		rc = keep(s, lba + i, j - i, &data[i]);
+		if (rc < 0)
+			return rc;
+	}
+	return 0;
+}
+
+/* Take the next count sectors from the input; a partial sector at the
+ * end is counted in s->bytes but never returned. */
+static uint32_t fill(struct sector_stream *s, Sector *buf, uint32_t count)
+{
+	size_t got, n;
+
+	got = fread(buf, 1, count * sizeof(Sector), s->in);
+	n = got / sizeof(Sector);
+	iostats.reads++;
+	iostats.bytes_read += got;
+	s->bytes += got;
+	s->pos += n;
+	if (n < count) {
+		if (ferror(s->in))
+			s->error = errno ? errno : EIO;
+		else
+			s->eof = 1;
+	}
+	return n;
+}
+
+/* Read up to (not including) sector lba, keeping what's wanted. */
+static int advance(struct sector_stream *s, uint32_t lba)
+{
+	while (s->pos < lba && !s->eof && !s->error) {
+		uint32_t start = s->pos;
+		uint32_t n = lba - s->pos < STREAM_CHUNK ? lba - s->pos
+							 : STREAM_CHUNK;
+
+		n = fill(s, s->scratch, n);
+		if (keep_wanted(s, start, n, s->scratch) < 0) {
+			s->error = errno;
+			return -1;
+		}
+	}
+	return s->pos == lba ? 0 : -1;
+}
+
+/* Copy what's been kept of the sectors from lba on; returns how many. */
+static uint32_t copy_kept(struct sector_stream *s, uint32_t lba,
+			  uint32_t count, Sector *sectors)
+{
+	int lo = 0, hi = s->nkept;
+
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		struct stream_extent *e = &s->kept[mid];
+
+		if (lba < e->lba) {
+			hi = mid;
+		} else if (lba - e->lba >= e->count) {
+			lo = mid + 1;
+		} else {
+			uint32_t n = e->count - (lba - e->lba);
+
+			if (n > count)
+				n = count;
+			memcpy(sectors, &e->data[lba - e->lba],
+			       n * sizeof(Sector));
+			return n;
+		}
+	}
+	return 0;
+}
+
+/* Like fread() at sector lba: returns the number of whole sectors read,
+ * short with errno set to ENODATA at the end of the input, or with
+ * s->error and errno set if the input failed or the sectors went by
+ * without being kept. */
+size_t stream_read(struct sector_stream *s, uint32_t lba, uint32_t count,
+		   Sector *sectors)
+{
+	uint32_t done = 0;
+
+	s->error = 0;
+	while (done < count) {
+		uint32_t sector = lba + done;
+		uint32_t n;
+
+		if (sector < s->pos) {
+			n = copy_kept(s, sector, count - done, &sectors[done]);
+			if (n == 0) {
+				fprintf(stderr, "dumpet: sector %u has already "
+					"gone by on a forward-only input\n",
+					sector);
+				s->error = ESPIPE;
+				break;
+			}
+			done += n;
+			continue;
+		}
+
+		if (advance(s, sector) < 0)
+			break;
+		n = fill(s, &sectors[done], count - done);
+		if (s->keep_reads || s->nwanted) {
+			int rc = s->keep_reads ?
+				 keep(s, sector, n, &sectors[done]) :
+				 keep_wanted(s, sector, n, &sectors[done]);
+
+			if (rc < 0 && !s->error)
+				s->error = -rc;
+		}
+		done += n;
+		if (s->eof || s->error)
+			break;
+	}
+	if (s->error)
+		errno = s->error;
+	else if (done < count)
+		errno = ENODATA;
+	return done;
+}
+
+/* Read to the end of the input, keeping what's wanted; afterwards
+ * s->bytes is its length. */
+int stream_finish(struct sector_stream *s)
+{
+	s->error = 0;
+	while (!s->eof && !s->error) {
+		uint32_t start = s->pos;
+		uint32_t n = fill(s, s->scratch, STREAM_CHUNK);
+
+		if (keep_wanted(s, start, n, s->scratch) < 0)
+			s->error = errno;
+	}
+	return s->error ? -s->error : 0;
+}
+
+/* Read whatever is left, so that whatever is writing to the input (a tee
+ * making a copy, say) isn't cut short, and free the stream. */
+int stream_close(struct sector_stream *s)
+{
+	int i, rc;
+
+	if (!s)
+		return 0;
+	s->nwanted = 0;
+	rc = stream_finish(s);
+
+	for (i = 0; i < s->nkept; i++)
+		free(s->kept[i].data);
+	free(s->kept);
+	free(s->wanted);
+	free(s->scratch);
+	free(s);
+	return rc;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
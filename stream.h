@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "iso9660.h"
+
+/* A forward-only input, such as a pipe.  Every read that would seek back
+ * is served from sectors kept as the input went by: those that have
+ * been asked for (descriptors, directories, the catalog), and those in
+ * extents registered with stream_want() before the input reaches them
+ * (boot images).  Everything else is read and dropped. */
+struct stream_range {
+	uint32_t lba;
+	uint32_t count;
+};
+
+struct stream_extent {
+	uint32_t lba;
+	uint32_t count;
+	Sector *data;
+};
+
+struct sector_stream {
+	FILE *in;
+	uint32_t pos;		/* the next sector the input will give us */
+	uint64_t bytes;		/* read from the input so far */
+	int eof;
+	int error;		/* errno from the last read, or 0 */
+	int keep_reads;		/* keep what's asked for, not just wanted */
+	struct stream_extent *kept;	/* sorted, non-overlapping */
+	int nkept;
+	struct stream_range *wanted;
+	int nwanted;
+	Sector *scratch;
+};
+
+/* set when the image isn't seekable; read_sectors() goes through it */
+extern struct sector_stream *input_stream;
+
+extern struct sector_stream *stream_open(FILE *in);
+extern int stream_want(struct sector_stream *s, uint32_t lba, uint32_t count);
+extern size_t stream_read(struct sector_stream *s, uint32_t lba,
+			  uint32_t count, Sector *sectors);
+extern int stream_finish(struct sector_stream *s);
+extern int stream_close(struct sector_stream *s);
+
+#endif /* STREAM_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
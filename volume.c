@@ -0,0 +1,651 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#define _FILE_OFFSET_BITS 64
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dumpet.h"
+#include "catalog.h"
+#include "volume.h"
+
+/* don't wander forever through a corrupt hierarchy */
+#define MAX_DIRECTORIES 65536
+
+static void copy_id(char *dst, const char *src, size_t n)
+{
+	memcpy(dst, src, n);
+	dst[n] = '\0';
+	while (n > 0 && dst[n-1] == ' ')
+		dst[--n] = '\0';
+}
+
+static void parse_primary_volume(PrimaryVolumeDescriptor *pvd,
+				 struct iso_volume *vol)
+{
+	DirectoryRecord *root;
+
+	vol->has_pvd = 1;
+	vol->VolumeSpaceSize = get_iso733(pvd->VolumeSpaceSize);
+	vol->LogicalBlockSize = get_iso723(pvd->LogicalBlockSize);
+	copy_id(vol->SystemId, pvd->SystemId, sizeof(pvd->SystemId));
+	copy_id(vol->VolumeId, pvd->VolumeId, sizeof(pvd->VolumeId));
+
+	vol->PathTables[0] = iso731_to_cpu32(pvd->LPathTable);
+	vol->PathTables[1] = iso731_to_cpu32(pvd->OptionalLPathTable);
+	vol->PathTables[2] = iso732_to_cpu32(pvd->MPathTable);
+	vol->PathTables[3] = iso732_to_cpu32(pvd->OptionalMPathTable);
+
+	root = (DirectoryRecord *)pvd->RootDirectoryRecord;
+	vol->RootExtent = get_iso733(root->ExtentLocation);
+	vol->RootSize = get_iso733(root->DataLength);
+}
+
+/* the ECMA-167 volume recognition sequence, which follows the ISO 9660
+ * terminator on UDF bridge media */
+static const char *vrs_ids[] = {
+	"BEA01", "NSR02", "NSR03", "TEA01", "BOOT2", "CDW02", NULL
+};
+
+static int is_vrs_id(const char *id)
+{
+	int i;
+
+	for (i = 0; vrs_ids[i]; i++)
+		if (!memcmp(id, vrs_ids[i], 5))
+			return 1;
+	return 0;
+}
+
+static int joliet_level(const uint8_t *escapes)
+{
+	if (escapes[0] != '%' || escapes[1] != '/')
+		return 0;
+	switch (escapes[2]) {
+		case '@': return 1;
+		case 'C': return 2;
+		case 'E': return 3;
+	}
+	return 0;
+}
+
+static void root_directory(PrimaryVolumeDescriptor *pvd,
+			   struct volume_descriptor *vd)
+{
+	DirectoryRecord *root = (DirectoryRecord *)pvd->RootDirectoryRecord;
+
+	vd->RootExtent = get_iso733(root->ExtentLocation);
+	vd->RootSize = get_iso733(root->DataLength);
+}
+
+/* Returns 1 once the end of the descriptor set has been reached. */
+static int add_descriptor(struct descriptor_set *set, uint32_t lba,
+			  Sector *sector)
+{
+	PrimaryVolumeDescriptor *pvd = (PrimaryVolumeDescriptor *)sector;
+	BootRecordVolumeDescriptor *br = (BootRecordVolumeDescriptor *)sector;
+	VolumePartitionDescriptor *vpd = (VolumePartitionDescriptor *)sector;
+	struct volume_descriptor *vd;
+	int cd001 = !memcmp(pvd->Iso9660, "CD001", 5);
+
+	if ((!cd001 || set->terminated) && !is_vrs_id(pvd->Iso9660)) {
+		memcpy(set->StopId, pvd->Iso9660, 5);
+		set->StopId[5] = '\0';
+		set->StopLBA = lba;
+		return 1;
+	}
+	if (set->ndescriptors == MAX_VOLUME_DESCRIPTORS) {
+		set->StopLBA = lba;
+		return 1;
+	}
+
+	vd = &set->descriptors[set->ndescriptors];
+	memset(vd, '\0', sizeof(*vd));
+	vd->lba = lba;
+	memcpy(vd->Id, pvd->Iso9660, 5);
+	vd->Type = pvd->Type;
+	vd->Version = pvd->Version;
+
+	if (!cd001)
+		goto out;
+
+	switch (pvd->Type) {
+		case BootRecordDescriptor:
+			memcpy(vd->BootSystemId, br->BootSystemId,
+			       sizeof(vd->BootSystemId));
+			copy_id(vd->SystemId, br->BootSystemId,
+				sizeof(br->BootSystemId));
+			if (set->boot_record < 0 &&
+					!strcmp(vd->SystemId,
+						"EL TORITO SPECIFICATION")) {
+				set->boot_record = set->ndescriptors;
+				set->BootCatalogLBA =
+					iso731_to_cpu32(br->BootCatalogLBA);
+			}
+			break;
+		case PrimaryDescriptor:
+			copy_id(vd->SystemId, pvd->SystemId,
+				sizeof(pvd->SystemId));
+			copy_id(vd->VolumeId, pvd->VolumeId,
+				sizeof(pvd->VolumeId));
+			root_directory(pvd, vd);
+			if (!set->primary.has_pvd)
+				parse_primary_volume(pvd, &set->primary);
+			break;
+		case SupplementaryDescriptor:
+			copy_id(vd->SystemId, pvd->SystemId,
+				sizeof(pvd->SystemId));
+			copy_id(vd->VolumeId, pvd->VolumeId,
+				sizeof(pvd->VolumeId));
+			vd->JolietLevel = joliet_level(pvd->EscapeSequences);
+			root_directory(pvd, vd);
+			break;
+		case PartitionDescriptor:
+			copy_id(vd->SystemId, vpd->SystemId,
+				sizeof(vpd->SystemId));
+			copy_id(vd->VolumeId, vpd->PartitionId,
+				sizeof(vpd->PartitionId));
+			vd->Extent = get_iso733(vpd->PartitionLocation);
+			vd->Size = get_iso733(vpd->PartitionSize);
+			break;
+		case TerminatorDescriptor:
+			set->terminated = 1;
+			break;
+	}
+out:
+	set->ndescriptors++;
+	if (!memcmp(vd->Id, "TEA01", 5)) {
+		set->StopLBA = lba + 1;
+		return 1;
+	}
+	return 0;
+}
+
+/* The descriptor set starts at sector 16 and runs to the terminator (plus
+ * the UDF recognition sequence after it, if there is one).  It's nearly
+ * always just a few sectors, so one read normally gets all of it. */
+#define DESCRIPTOR_BATCH 32
+
+int read_descriptor_set(FILE *iso, struct descriptor_set *set)
+{
+	Sector *batch;
+	uint32_t lba = 16;
+	int done = 0;
+	int i, n;
+
+	memset(set, '\0', sizeof(*set));
+	set->boot_record = -1;
+
+	batch = malloc(DESCRIPTOR_BATCH * sizeof(Sector));
+	if (!batch)
+		return -errno;
+
+	while (!done) {
+		n = read_sectors_upto(iso, lba, DESCRIPTOR_BATCH, batch);
+		if (n < 0) {
+			free(batch);
+			return n;
+		}
+		for (i = 0; i < n && !done; i++)
+			done = add_descriptor(set, lba + i, &batch[i]);
+		if (!done && n < DESCRIPTOR_BATCH) {
+			set->StopLBA = lba + n;
+			done = 1;
+		}
+		lba += n;
+	}
+
+	free(batch);
+	return 0;
+}
+
+const char *descriptor_name(struct volume_descriptor *vd)
+{
+	if (!memcmp(vd->Id, "CD001", 5)) {
+		switch (vd->Type) {
+			case BootRecordDescriptor:
+				return "Boot Record Volume Descriptor";
+			case PrimaryDescriptor:
+				return "Primary Volume Descriptor";
+			case SupplementaryDescriptor:
+				if (vd->Version == 2)
+					return "Enhanced Volume Descriptor";
+				return "Supplementary Volume Descriptor";
+			case PartitionDescriptor:
+				return "Volume Partition Descriptor";
+			case TerminatorDescriptor:
+				return "Volume Descriptor Set Terminator";
+		}
+		return "Unknown Volume Descriptor";
+	}
+	if (!memcmp(vd->Id, "BEA01", 5))
+		return "Beginning Extended Area Descriptor";
+	if (!memcmp(vd->Id, "NSR02", 5) || !memcmp(vd->Id, "NSR03", 5))
+		return "UDF NSR Descriptor";
+	if (!memcmp(vd->Id, "TEA01", 5))
+		return "Terminating Extended Area Descriptor";
+	if (!memcmp(vd->Id, "BOOT2", 5))
+		return "Boot Descriptor";
+	if (!memcmp(vd->Id, "CDW02", 5))
+		return "CD-WO Descriptor";
+	return "Unknown Volume Descriptor";
+}
+
+/* The directories already queued, so that a corrupt or looping
+ * hierarchy is walked only once. */
+struct dir_set {
+	uint32_t *slots;	/* open addressing; 0 is empty */
+	uint32_t mask;
+	uint32_t n;
+};
+
+static int dir_set_grow(struct dir_set *set)
+{
+	uint32_t size = set->slots ? (set->mask + 1) * 2 : 1024;
+	uint32_t *slots = calloc(size, sizeof(*slots));
+	uint32_t i, j;
+
+	if (!slots)
+		return -errno;
+	for (i = 0; set->slots && i <= set->mask; i++) {
+		if (!set->slots[i])
+			continue;
+		for (j = set->slots[i] * 2654435761u & (size - 1); slots[j];
+				j = (j + 1) & (size - 1))
+			;
+		slots[j] = set->slots[i];
+	}
+	free(set->slots);
+	set->slots = slots;
+	set->mask = size - 1;
+	return 0;
+}
+
+/* Returns 1 if extent is new, 0 if it was already there. */
+static int dir_set_add(struct dir_set *set, uint32_t extent)
+{
+	uint32_t i;
+	int rc;
+
+	if ((set->n + 1) * 2 > (set->slots ? set->mask + 1 : 0)) {
+		rc = dir_set_grow(set);
+		if (rc < 0)
+			return rc;
+	}
+	for (i = extent * 2654435761u & set->mask; set->slots[i];
+			i = (i + 1) & set->mask)
+		if (set->slots[i] == extent)
+			return 0;
+	set->slots[i] = extent;
+	set->n++;
+	return 1;
+}
+
+struct dirwalk {
+	struct dir_set seen;
+	struct {
+		uint32_t extent;
+		uint32_t size;
+	} *queue;
+	int nqueued;
+	int queue_alloc;
+	int next;
+	struct file_map *map;
+	int records_alloc;
+	int used_alloc;
+};
+
+/* Make room for one more element after the first n. */
+static void *grow(void *array, int *alloc, int n, size_t size)
+{
+	int new_alloc;
+
+	if (n < *alloc)
+		return array;
+	new_alloc = *alloc ? *alloc * 2 : 64;
+	array = realloc(array, new_alloc * size);
+	if (array)
+		*alloc = new_alloc;
+	return array;
+}
+
+static int append_used(struct dirwalk *walk, uint32_t extent)
+{
+	struct file_map *map = walk->map;
+	uint32_t *used;
+
+	used = grow(map->used, &walk->used_alloc, map->nused, sizeof(*used));
+	if (!used)
+		return -errno;
+	map->used = used;
+	map->used[map->nused++] = extent;
+	return 0;
+}
+
+static int append_record(struct dirwalk *walk, struct file_record *record)
+{
+	struct file_map *map = walk->map;
+	struct file_record *records;
+
+	records = grow(map->records, &walk->records_alloc, map->nrecords,
+		       sizeof(*records));
+	if (!records)
+		return -errno;
+	map->records = records;
+	map->records[map->nrecords++] = *record;
+	return 0;
+}
+
+static int queue_directory(struct dirwalk *walk, uint32_t extent,
+			   uint32_t size)
+{
+	void *queue;
+	int rc;
+
+	if (extent == 0)
+		return 0;
+	rc = dir_set_add(&walk->seen, extent);
+	if (rc <= 0)
+		return rc;
+	if (walk->nqueued == MAX_DIRECTORIES)
+		return 0;
+	queue = grow(walk->queue, &walk->queue_alloc, walk->nqueued,
+		     sizeof(*walk->queue));
+	if (!queue)
+		return -errno;
+	walk->queue = queue;
+	walk->queue[walk->nqueued].extent = extent;
+	walk->queue[walk->nqueued].size = size;
+	walk->nqueued++;
+	return append_used(walk, extent);
+}
+
+static int read_directory(struct dirwalk *walk, uint8_t tree, uint32_t lba,
+			  Sector *dir, uint32_t sectors)
+{
+	uint32_t s;
+	int rc = 0;
+
+	for (s = 0; s < sectors && rc == 0; s++) {
+		uint32_t off = 0;
+
+		while (off + sizeof(DirectoryRecord) <= sizeof(Sector) &&
+				rc == 0) {
+			DirectoryRecord *dr = (DirectoryRecord *)(dir[s] + off);
+			struct file_record record;
+
+			if (dr->Length == 0)
+				break;
+			if (dr->Length < sizeof(*dr) + dr->FileIdentifierLength ||
+			    off + dr->Length > sizeof(Sector))
+				break;
+
+			/* skip "." and ".." */
+			if (dr->FileIdentifierLength == 1 &&
+			    (dr->FileIdentifier[0] == 0 ||
+			     dr->FileIdentifier[0] == 1)) {
+				off += dr->Length;
+				continue;
+			}
+
+			record.extent = get_iso733(dr->ExtentLocation);
+			record.size = get_iso733(dr->DataLength);
+			if (dr->FileFlags & DIRECTORY_RECORD_DIRECTORY) {
+				rc = queue_directory(walk, record.extent,
+						     record.size);
+			} else {
+				record.flags = dr->FileFlags;
+				record.tree = tree;
+				record.sector = lba + s;
+				record.offset = off;
+				rc = append_record(walk, &record);
+				if (rc == 0 && record.size > 0)
+					rc = append_used(walk, record.extent);
+			}
+			off += dr->Length;
+		}
+	}
+	return rc;
+}
+
+static int walk_tree(FILE *iso, struct dirwalk *walk, uint8_t tree,
+		     uint32_t root, uint32_t root_size)
+{
+	Sector *dir = NULL;
+	int rc;
+
+	rc = queue_directory(walk, root, root_size);
+	while (rc == 0 && walk->next < walk->nqueued) {
+		uint32_t lba = walk->queue[walk->next].extent;
+		uint32_t sectors = (walk->queue[walk->next].size +
+				    sizeof(Sector) - 1) / sizeof(Sector);
+
+		walk->next++;
+		if (sectors == 0 || lba + sectors > walk->map->VolumeSpaceSize ||
+				lba + sectors < lba)
+			continue;
+
+		free(dir);
+		dir = malloc(sectors * sizeof(Sector));
+		if (!dir) {
+			rc = -errno;
+			break;
+		}
+		if (read_sectors(iso, lba, sectors, dir) < 0) {
+			rc = -errno;
+			break;
+		}
+		rc = read_directory(walk, tree, lba, dir, sectors);
+	}
+	free(dir);
+	return rc;
+}
+
+static int compare_records(const void *a, const void *b)
+{
+	const struct file_record *ra = a, *rb = b;
+
+	if (ra->extent != rb->extent)
+		return ra->extent < rb->extent ? -1 : 1;
+	if (ra->tree != rb->tree)
+		return ra->tree < rb->tree ? -1 : 1;
+	if (ra->sector != rb->sector)
+		return ra->sector < rb->sector ? -1 : 1;
+	return ra->offset < rb->offset ? -1 : ra->offset > rb->offset;
+}
+
+static int compare_extents(const void *a, const void *b)
+{
+	uint32_t ea = *(const uint32_t *)a, eb = *(const uint32_t *)b;
+
+	return ea < eb ? -1 : ea > eb;
+}
+
+/* Walk the primary tree and each supplementary one, reading every
+ * directory once. */
+struct file_map *read_file_map(FILE *iso, struct descriptor_set *set)
+{
+	struct dirwalk walk = { { 0 } };
+	struct file_map *map;
+	uint8_t tree = 0;
+	int i, j, rc = 0;
+
+	map = calloc(1, sizeof(*map));
+	if (!map)
+		return NULL;
+	walk.map = map;
+	if (!set->primary.has_pvd)
+		return map;
+	map->VolumeSpaceSize = set->primary.VolumeSpaceSize;
+
+	for (i = 0; i < 4 && rc == 0; i++)
+		if (set->primary.PathTables[i])
+			rc = append_used(&walk, set->primary.PathTables[i]);
+	if (rc == 0)
+		rc = walk_tree(iso, &walk, tree++, set->primary.RootExtent,
+			       set->primary.RootSize);
+	for (i = 0; i < set->ndescriptors && rc == 0; i++) {
+		struct volume_descriptor *vd = &set->descriptors[i];
+
+		if (strcmp(vd->Id, "CD001") ||
+				vd->Type != SupplementaryDescriptor)
+			continue;
+		rc = walk_tree(iso, &walk, tree++, vd->RootExtent,
+			       vd->RootSize);
+	}
+	free(walk.seen.slots);
+	free(walk.queue);
+	if (rc < 0) {
+		free_file_map(map);
+		errno = -rc;
+		return NULL;
+	}
+
+	qsort(map->records, map->nrecords, sizeof(*map->records),
+	      compare_records);
+	qsort(map->used, map->nused, sizeof(*map->used), compare_extents);
+	for (i = 0, j = 0; i < map->nused; i++)
+		if (j == 0 || map->used[i] != map->used[j - 1])
+			map->used[j++] = map->used[i];
+	map->nused = j;
+	return map;
+}
+
+void free_file_map(struct file_map *map)
+{
+	if (!map)
+		return;
+	free(map->records);
+	free(map->used);
+	free(map);
+}
+
+/* The map of context->volume, read the first time anything asks. */
+struct file_map *get_file_map(struct context *context)
+{
+	if (!context->files && context->volume) {
+		context->files = read_file_map(context->iso, context->volume);
+		if (!context->files)
+			fprintf(stderr, "dumpet: Error reading the directory "
+				"hierarchy: %m\n");
+	}
+	return context->files;
+}
+
+/* the first record for extent, or nrecords */
+static int first_record(struct file_map *map, uint32_t extent)
+{
+	int lo = 0, hi = map->nrecords;
+
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+
+		if (map->records[mid].extent < extent)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* Find the file whose data starts at "extent", preferring its record in
+ * the primary tree, and the closest extent after it that anything in the
+ * hierarchy uses.  Returns 1 if found, 0 if not. */
+int find_file_by_extent(struct file_map *map, uint32_t extent,
+			struct iso_file *file)
+{
+	struct file_record *record;
+	int lo = 0, hi = map->nused;
+	int i;
+
+	memset(file, '\0', sizeof(*file));
+	file->extent = extent;
+	file->next_extent = map->VolumeSpaceSize;
+
+	i = first_record(map, extent);
+	if (i == map->nrecords || map->records[i].extent != extent)
+		return 0;
+	record = &map->records[i];
+	file->size = record->size;
+	file->flags = record->flags;
+	file->record_sector = record->sector;
+	file->record_offset = record->offset;
+
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+
+		if (map->used[mid] <= extent)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo < map->nused && map->used[lo] < file->next_extent)
+		file->next_extent = map->used[lo];
+	return 1;
+}
+
+/* How much of the image belongs to a boot entry: the whole file it
+ * points at if the hierarchy has it, and otherwise what the catalog
+ * says.  map may be NULL. */
+uint32_t boot_image_sectors(struct file_map *map, struct boot_entry *entry)
+{
+	struct iso_file file;
+
+	if (map && find_file_by_extent(map, entry->LoadLBA, &file) &&
+			file.size)
+		return (file.size + sizeof(Sector) - 1) / sizeof(Sector);
+	return boot_entry_sectors(entry);
+}
+
+/* Update the file's record in every directory tree, not just the one
+ * find_file_by_extent() returned; ISO 9660 readers that prefer Joliet
+ * would otherwise see the old size. */
+int set_file_size(FILE *iso, struct file_map *map, struct iso_file *file,
+		  uint32_t size)
+{
+	int i;
+
+	for (i = first_record(map, file->extent);
+	     i < map->nrecords && map->records[i].extent == file->extent;
+	     i++) {
+		struct file_record *record = &map->records[i];
+		DirectoryRecord *dr;
+		Sector sector;
+		int rc;
+
+		rc = read_sector(iso, record->sector, &sector);
+		if (rc < 0)
+			return rc;
+		dr = (DirectoryRecord *)(sector + record->offset);
+		if (get_iso733(dr->ExtentLocation) != file->extent) {
+			errno = EINVAL;
+			return -errno;
+		}
+		set_iso733(dr->DataLength, size);
+		rc = write_sector_sync(iso, record->sector, &sector);
+		if (rc < 0)
+			return rc;
+		record->size = size;
+	}
+	file->size = size;
+	return 0;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
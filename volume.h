@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VOLUME_H
+#define VOLUME_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "iso9660.h"
+
+/* What we need to know about the ISO 9660 volume itself. */
+struct iso_volume {
+	int has_pvd;
+	uint32_t VolumeSpaceSize;
+	uint16_t LogicalBlockSize;
+	char SystemId[33];
+	char VolumeId[33];
+	uint32_t RootExtent;
+	uint32_t RootSize;
+	uint32_t PathTables[4];
+};
+
+/* A file found in the directory hierarchy, where its directory record
+ * lives so that it can be updated in place, and the first sector after it
+ * that is known to be in use by anything else. */
+struct iso_file {
+	uint32_t extent;
+	uint32_t size;
+	uint8_t flags;
+	uint32_t record_sector;
+	uint32_t record_offset;
+	uint32_t next_extent;
+};
+
+/* ECMA-119 8.1 (and ECMA-167 2/9 for the volume recognition sequence) */
+#define MAX_VOLUME_DESCRIPTORS 64
+
+struct volume_descriptor {
+	uint32_t lba;
+	char Id[6];		/* "CD001", "BEA01", "NSR02", ... */
+	uint8_t Type;		/* VolumeDescriptorType, for CD001 only */
+	uint8_t Version;
+	char SystemId[33];	/* boot system ID for boot records */
+	char VolumeId[33];	/* partition ID for partitions */
+	uint32_t Extent;	/* partitions only */
+	uint32_t Size;
+	int JolietLevel;	/* supplementary only */
+	uint32_t RootExtent;	/* primary and supplementary only */
+	uint32_t RootSize;
+	uint8_t BootSystemId[32]; /* boot records only, untrimmed */
+};
+
+struct descriptor_set {
+	int ndescriptors;
+	int terminated;
+	char StopId[6];		/* the identifier that ended the walk */
+	uint32_t StopLBA;
+	int boot_record;	/* index of the El Torito boot record, or -1 */
+	uint32_t BootCatalogLBA;
+	struct iso_volume primary;
+	struct volume_descriptor descriptors[MAX_VOLUME_DESCRIPTORS];
+};
+
+/* A file's directory record in one of the volume's directory trees. */
+struct file_record {
+	uint32_t extent;
+	uint32_t size;
+	uint8_t flags;
+	uint8_t tree;		/* 0 for the primary, then each supplementary */
+	uint32_t sector;	/* where the record lives */
+	uint32_t offset;
+};
+
+/* Every file record in the primary and supplementary (Joliet) trees,
+ * from one walk of the hierarchy, sorted by extent with the primary
+ * tree's first; and every extent anything in the hierarchy uses. */
+struct file_map {
+	uint32_t VolumeSpaceSize;
+	struct file_record *records;
+	int nrecords;
+	uint32_t *used;		/* sorted, no duplicates */
+	int nused;
+};
+
+struct context;
+struct boot_entry;
+
+extern int read_descriptor_set(FILE *iso, struct descriptor_set *set);
+extern const char *descriptor_name(struct volume_descriptor *vd);
+extern struct file_map *read_file_map(FILE *iso, struct descriptor_set *set);
+extern void free_file_map(struct file_map *map);
+extern struct file_map *get_file_map(struct context *context);
+extern int find_file_by_extent(struct file_map *map, uint32_t extent,
+			       struct iso_file *file);
+extern uint32_t boot_image_sectors(struct file_map *map,
+				   struct boot_entry *entry);
+extern int set_file_size(FILE *iso, struct file_map *map,
+			 struct iso_file *file, uint32_t size);
+
+#endif /* VOLUME_H */
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE 1
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+
+#define XMLLOAD_NO_REDIRECT 1
+#include "xmlload.h"
+
+/* libxml2 2.14 changed its soname; ask for the one we were built against. */
+#if LIBXML_VERSION >= 21400
+#define LIBXML_SONAME "libxml2.so.16"
+#else
+#define LIBXML_SONAME "libxml2.so.2"
+#endif
+
+struct libxml libxml;
+
+int load_libxml(void)
+{
+	static int loaded;
+	const char *missing = NULL;
+	void *handle;
+
+	if (loaded)
+		return 0;
+
+	handle = dlopen(LIBXML_SONAME, RTLD_NOW | RTLD_LOCAL);
+	if (!handle) {
+		fprintf(stderr, "dumpet: XML output needs libxml2: %s\n",
+			dlerror());
+		return -1;
+	}
+
+#define LIBXML_RESOLVE(name)					\
+	if (!missing && !(libxml.name = dlsym(handle, #name)))	\
+		missing = #name;
+	LIBXML_FUNCTIONS(LIBXML_RESOLVE)
+#undef LIBXML_RESOLVE
+
+	if (missing) {
+		fprintf(stderr, "dumpet: %s has no %s\n", LIBXML_SONAME,
+			missing);
+		memset(&libxml, '\0', sizeof(libxml));
+		dlclose(handle);
+		return -1;
+	}
+
+	/* The handle stays open for the rest of the run. */
+	loaded = 1;
+	return 0;
+}
+
+/* vim:set shiftwidth=8 softtabstop=8: */
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef XMLLOAD_H
+#define XMLLOAD_H 1
+
+#include <libxml/encoding.h>
+#include <libxml/xmlwriter.h>
+
+/* libxml2 (and the ICU it drags in) is only needed for XML output, so it
+ * is dlopen()ed the first time an XML renderer is set up rather than being
+ * linked into every run.  The calls in render_xml.c go through this table;
+ * the macros below keep them spelled the way libxml2 documents them. */
+#define LIBXML_FUNCTIONS(f)				\
+	f(xmlOutputBufferCreateIO)			\
+	f(xmlOutputBufferClose)				\
+	f(xmlNewTextWriter)				\
+	f(xmlFreeTextWriter)				\
+	f(xmlTextWriterStartDocument)			\
+	f(xmlTextWriterEndDocument)			\
+	f(xmlTextWriterStartElement)			\
+	f(xmlTextWriterEndElement)			\
+	f(xmlTextWriterStartAttribute)			\
+	f(xmlTextWriterEndAttribute)			\
+	f(xmlTextWriterWriteAttribute)			\
+	f(xmlTextWriterWriteFormatAttribute)		\
+	f(xmlTextWriterWriteFormatElement)		\
+	f(xmlTextWriterWriteString)			\
+	f(xmlTextWriterWriteBinHex)			\
+	f(xmlTextWriterWriteRawLen)
+
+#define LIBXML_POINTER(name) __typeof__(name) *name;
+struct libxml {
+	LIBXML_FUNCTIONS(LIBXML_POINTER)
+};
+#undef LIBXML_POINTER
+
+extern struct libxml libxml;
+extern int load_libxml(void);
+
+#ifndef XMLLOAD_NO_REDIRECT
+#define xmlOutputBufferCreateIO		libxml.xmlOutputBufferCreateIO
+#define xmlOutputBufferClose		libxml.xmlOutputBufferClose
+#define xmlNewTextWriter		libxml.xmlNewTextWriter
+#define xmlFreeTextWriter		libxml.xmlFreeTextWriter
+#define xmlTextWriterStartDocument	libxml.xmlTextWriterStartDocument
+#define xmlTextWriterEndDocument	libxml.xmlTextWriterEndDocument
+#define xmlTextWriterStartElement	libxml.xmlTextWriterStartElement
+#define xmlTextWriterEndElement		libxml.xmlTextWriterEndElement
+#define xmlTextWriterStartAttribute	libxml.xmlTextWriterStartAttribute
+#define xmlTextWriterEndAttribute	libxml.xmlTextWriterEndAttribute
+#define xmlTextWriterWriteAttribute	libxml.xmlTextWriterWriteAttribute
+#define xmlTextWriterWriteFormatAttribute libxml.xmlTextWriterWriteFormatAttribute
+#define xmlTextWriterWriteFormatElement	libxml.xmlTextWriterWriteFormatElement
+#define xmlTextWriterWriteString	libxml.xmlTextWriterWriteString
+#define xmlTextWriterWriteBinHex	libxml.xmlTextWriterWriteBinHex
+#define xmlTextWriterWriteRawLen	libxml.xmlTextWriterWriteRawLen
+#endif
+
+#endif /* XMLLOAD_H */
+/* vim:set shiftwidth=8 softtabstop=8: */